@@ -21,7 +21,31 @@
       $readmemh(filename, memory); \
     end
 
+// Frame memory location:
+//   default               on-chip ROM in nyancat.v, read with MEM_READ
+//   NYANCAT_FRAME_MEM_WB  external slave behind a Wishbone B4 pipelined
+//                         read port (wb_* ports of nyancat and vga_nyancat);
+//                         the palette stays on chip
+//   NYANCAT_FRAME_RLE     on-chip ROM of run-length rows (nyancat-rle*.hex)
+//                         expanded into row buffers by nyancat.v; needs the
+//                         generated nyancat-rle.vh on the include path
+//   NYANCAT_FRAME_DELTA   64x64 frame buffer loaded with a keyframe and
+//                         patched in vertical blanking from per-step change
+//                         lists (nyancat-key.hex, nyancat-delta*.hex); needs
+//                         the generated nyancat-delta.vh on the include path
+
+// Frame memory read latency beyond the ROM's one clock (0-16). nyancat.v
+// issues frame reads this many clocks ahead of the beam (prefetch), so the
+// output timing does not change.
+`ifndef MEM_LATENCY
+  `define MEM_LATENCY 0
+`endif
+
 // Memory sizing parameters (can be overridden if needed)
+`ifndef FRAME_MEM_ADDR_WIDTH
+  `define FRAME_MEM_ADDR_WIDTH 16  // 64K addresses (49,152 used)
+`endif
+
 `ifndef FRAME_MEM_DATA_WIDTH
   `define FRAME_MEM_DATA_WIDTH 4   // 4-bit character indices
 `endif
@@ -9,6 +9,23 @@
 // Include memory interface definitions
 `include "memory_if.vh"
 
+// Encoded frame ROM sizes (generated by scripts/gen-nyancat.py). Encoded
+// builds keep the plain frame_mem in simulation only, as a reference.
+`ifdef NYANCAT_FRAME_RLE
+`define NYANCAT_FRAME_ENCODED
+`include "nyancat-rle.vh"
+`elsif NYANCAT_FRAME_DELTA
+`define NYANCAT_FRAME_ENCODED
+`include "nyancat-delta.vh"
+`endif
+
+// Builds whose picture changes frame in vertical blanking only
+`ifdef NYANCAT_FRAME_DELTA
+`define NYANCAT_FRAME_VBLANK
+`elsif NYANCAT_FRAME_VSYNC
+`define NYANCAT_FRAME_VBLANK
+`endif
+
 // Nyancat Animation Display Module
 //
 // Reads pre-compressed animation data from ROM and outputs VGA-compatible color
@@ -19,22 +36,59 @@
 //   - Auto-scaling based on vertical resolution (SCALE = V_ACTIVE / FRAME_H)
 //   - Nearest-neighbor upscaling with horizontal centering
 //   - 2-stage pipeline: ROM address → frame ROM → palette ROM → color output
+//   - Optional line buffer (`define NYANCAT_LINE_BUFFER): each source row is
+//     fetched from ROM once and replayed from a 64-entry buffer for the other
+//     SCALE-1 scanlines
 //   - Frame sequencing: ~11 fps (90ms/frame at 31.5MHz pixel clock)
+//   - PPC (`define PIXELS_PER_CLOCK, 1 or 2) pixel lanes per clock; each lane
+//     has its own ROM reads and pipeline, and rrggbb packs one 6-bit color
+//     per lane (lane 0 = left pixel in bits [5:0])
+//   - Optional external frame memory (`define NYANCAT_FRAME_MEM_WB): frame
+//     reads go out on a Wishbone B4 pipelined read port instead of frame_mem
+//   - Prefetch (`define MEM_LATENCY N, 0-16): ROM addresses run N clocks
+//     ahead of the beam, so a frame memory read may take N extra clocks
+//   - Optional run-length frame ROM (`define NYANCAT_FRAME_RLE): rows are
+//     stored as runs and expanded into two row buffers during blanking
+//   - Optional delta frames (`define NYANCAT_FRAME_DELTA): one frame buffer,
+//     patched from frame to frame during vertical blanking
+//   - Optional tear-free sequencing (`define NYANCAT_FRAME_VSYNC): an
+//     animation step that comes due mid-picture waits for vertical blanking
+//   - Optional programmable timing (`define VGA_TIMING_REGS): SCALE and
+//     OFFSET_X are registers loaded with vga_sync_gen's timing (PPC=1, raw
+//     frame ROM, immediate frame advance)
 //
 // Memory layout:
 //   frame_mem[49,152×4b]: Character indices for all 12 frames (2 chars/byte)
 //   color_mem[16×6b]:     14-color palette (6-bit VGA: RRGGBB)
+//   NYANCAT_FRAME_RLE:    rle_mem[words×8b] + rle_index[768] replace frame_mem
+//   NYANCAT_FRAME_DELTA:  frame_buf[4096×4b] + delta_mem[words×16b] + delta_index[13]
 //   Total ROM: ~24KB (230× compression vs. full 24-bit RGB storage)
 //
 // Data flow:
 //   {x_px, y_px} → coord transform → ROM address → char_idx → color → rrggbb
 module nyancat (
-    input  wire                     px_clk,       // Pixel clock (mode-dependent)
-    input  wire                     reset,        // Synchronous reset
-    input  wire [X_COORD_WIDTH-1:0] x_px,         // Current pixel X [0, H_ACTIVE-1]
-    input  wire [Y_COORD_WIDTH-1:0] y_px,         // Current pixel Y [0, V_ACTIVE-1]
-    input  wire                     activevideo,  // High during active display region
-    output wire [              5:0] rrggbb        // 6-bit VGA color output (2R2G2B)
+    input  wire                              px_clk,       // Pixel clock (mode-dependent)
+    input  wire                              reset,        // Synchronous reset
+    input  wire [         X_COORD_WIDTH-1:0] x_px,         // Current pixel X [0, H_ACTIVE-1] (lane 0)
+    input  wire [         Y_COORD_WIDTH-1:0] y_px,         // Current pixel Y [0, V_ACTIVE-1]
+    input  wire                              activevideo,  // High during active display region
+`ifdef VGA_TIMING_REGS
+    input  wire                              cfg_we,       // Timing register write (SCALE, OFFSET_X)
+    input  wire [                       3:0] cfg_addr,     // TIMING_REG_* (videomode.vh)
+    input  wire [                      15:0] cfg_wdata,    // Register value
+    input  wire                              timing_load,  // vga_sync_gen loads its timing this clock
+`endif
+`ifdef NYANCAT_FRAME_MEM_WB
+    // Wishbone B4 pipelined read master for frame data (PPC must be 1)
+    output wire                              wb_cyc_o,     // Bus cycle (requests in flight)
+    output wire                              wb_stb_o,     // Read request this clock
+    output wire                              wb_we_o,      // Always 0 (read-only)
+    output wire [ `FRAME_MEM_ADDR_WIDTH-1:0] wb_adr_o,     // frame_mem address
+    input  wire [ `FRAME_MEM_DATA_WIDTH-1:0] wb_dat_i,     // Character index
+    input  wire                              wb_ack_i,     // Oldest request done
+    input  wire                              wb_stall_i,   // Request not accepted
+`endif
+    output wire [                 6*PPC-1:0] rrggbb        // 6-bit VGA color (2R2G2B) per lane
 );
     // =========================================================================
     // Configuration Parameters
@@ -50,30 +104,98 @@ module nyancat (
     // Use H_ACTIVE and V_ACTIVE from videomode.vh instead of hardcoded values
     localparam OFFSET_X = (H_ACTIVE - SCALED_W) / 2, OFFSET_Y = 0;  // Centering offsets
 
+    // Geometry in use: the constants above, or with VGA_TIMING_REGS the
+    // scale/offset_x registers, reset to them and written like the timing
+    // registers (shadow copies loaded at timing_load, the edge the new mode
+    // starts on). SCALE_MAX sizes the sub-pixel counters.
+`ifdef VGA_TIMING_REGS
+    localparam SCALE_MAX = V_ACTIVE_MAX / FRAME_H;  // 12 (XGA)
+    localparam SCALE_W = $clog2(SCALE_MAX + 1);
+
+    reg [SCALE_W-1:0] scale, scale_cfg;
+    reg [X_COORD_WIDTH-1:0] offset_x, offset_x_cfg;
+
+    /* verilator lint_off WIDTHTRUNC */
+    always @(posedge px_clk) begin
+        if (reset) begin
+            scale        <= SCALE;
+            offset_x     <= OFFSET_X;
+            scale_cfg    <= SCALE;
+            offset_x_cfg <= OFFSET_X;
+        end else begin
+            if (cfg_we && cfg_addr == `TIMING_REG_SCALE) scale_cfg <= cfg_wdata;
+            if (cfg_we && cfg_addr == `TIMING_REG_OFFSET_X) offset_x_cfg <= cfg_wdata;
+            if (timing_load) begin
+                scale    <= scale_cfg;
+                offset_x <= offset_x_cfg;
+            end
+        end
+    end
+    /* verilator lint_on WIDTHTRUNC */
+`else
+    localparam SCALE_MAX = SCALE;
+    localparam SCALE_W = $clog2(SCALE_MAX + 1);
+
+    wire [SCALE_W-1:0] scale = SCALE;
+    wire [X_COORD_WIDTH-1:0] offset_x = OFFSET_X;
+`endif
+    wire [SCALE_W+5:0] scaled_w = {scale, 6'b0}, scaled_h = {scale, 6'b0};  // 64 × scale
+
     // Animation timing
     localparam NUM_FRAMES = 12;  // Total animation frames
     localparam FRAME_ADDR_W = $clog2(NUM_FRAMES * FRAME_W * FRAME_H);  // 16-bit ROM address
-    localparam FRAME_PERIOD = 2_835_000;  // Clocks per frame (~90ms)
+    localparam FRAME_PERIOD = 2_835_000;  // Pixel clocks per frame (~90ms), multiple of PPC
 
     // =========================================================================
     // Frame Sequencing
     // =========================================================================
+    // FRAME_PERIOD is not a multiple of the video frame, so a step normally
+    // lands mid-picture and that video frame shows the top of one animation
+    // frame and the bottom of the next (a tear). With NYANCAT_FRAME_VSYNC the
+    // counter still wraps every FRAME_PERIOD, but the step is held pending
+    // and applied at the start of vertical blanking (vblank_start); the
+    // animation rate is unchanged, each frame just shows up to one video
+    // frame late. Delta builds get the same effect from show_frame.
 
-    reg [21:0] frame_counter;  // Counts clocks within current frame
-    reg [ 3:0] frame_index;  // Current frame number [0, 11]
+    reg  [21:0] frame_counter;  // Counts pixel clocks within current frame
+    reg  [ 3:0] frame_index  /* verilator public_flat_rd */;  // Current frame number [0, 11]
+    wire [ 3:0] next_index = (frame_index == NUM_FRAMES - 1) ? 0 : frame_index + 1;
+    wire        frame_wrap = (frame_counter >= FRAME_PERIOD - PPC);  // Step due this clock
+    localparam [21:0] FRAME_STEP = PPC;  // Pixel clocks per clock
+`ifdef NYANCAT_FRAME_VBLANK
+    wire vblank_start;  // The clock after the last display pixel (assigned below Step 1)
+`endif
+`ifdef NYANCAT_FRAME_VSYNC
+    reg step_pending;  // A step came due and waits for vblank_start
+`endif
+`ifdef NYANCAT_FRAME_DELTA
+    reg [3:0] show_frame  /* verilator public_flat_rd */ = 0;  // Frame in the delta frame buffer (Frame Buffer below)
+`endif
 
-    // Advance to next frame every FRAME_PERIOD clocks (creates ~11 fps animation)
+    // Advance to next frame every FRAME_PERIOD pixel clocks (creates ~11 fps animation)
     always @(posedge px_clk) begin
         if (reset) begin
             frame_counter <= 0;
             frame_index   <= 0;
+`ifdef NYANCAT_FRAME_VSYNC
+            step_pending  <= 0;
+`endif
         end else begin
-            if (frame_counter >= FRAME_PERIOD - 1) begin
+            if (frame_wrap) begin
                 frame_counter <= 0;
-                frame_index   <= (frame_index == NUM_FRAMES - 1) ? 0 : frame_index + 1;
             end else begin
-                frame_counter <= frame_counter + 1;
+                frame_counter <= frame_counter + FRAME_STEP;
+            end
+`ifdef NYANCAT_FRAME_VSYNC
+            if (vblank_start) begin
+                if (step_pending || frame_wrap) frame_index <= next_index;
+                step_pending <= 0;
+            end else if (frame_wrap) begin
+                step_pending <= 1;
             end
+`else
+            if (frame_wrap) frame_index <= next_index;
+`endif
         end
     end
 
@@ -81,59 +203,749 @@ module nyancat (
     // Coordinate Transformation and ROM Addressing
     // =========================================================================
     // Transform input pixel coordinates to ROM addresses:
-    //   1. Remove centering offset → relative coordinates [0, SCALED_W-1]
-    //   2. Descale by SCALE factor → source frame coordinates [0,63]×[0,63]
-    //   3. Calculate ROM address from frame index and source coordinates
+    //   1. Bounds-check against the centered display window
+    //   2. Track source frame coordinates [0,63]×[0,63] with incremental
+    //      counters (no divider on the pixel path)
+    //   3. Concatenate frame index and source coordinates into the ROM address
+
+    // Lane pixels: lane l addresses pixel x_px + LANE_SKEW + l. x_px trails hc
+    // by one clock and the pipeline adds two, so with PPC=1 a pixel appears
+    // three pixel clocks after its x_px (the picture sits 3 pixels right of
+    // OFFSET_X). With PPC=2 those three clocks are six pixels; addressing
+    // LANE_SKEW = 3 pixels ahead keeps the picture where PPC=1 puts it, so
+    // both builds produce identical frames (checked by --lockstep).
+    localparam LANE_SKEW = 3 * (PPC - 1);
 
-    // Step 1: Remove centering offset to get coordinates relative to animation area
-    // Bounds check first to avoid underflow, then compute relative coordinates
+    // Prefetch: the address side runs MEM_LAT clocks (FETCH_LEAD pixels)
+    // ahead of the beam; see "Prefetch" below. The picture is at least 96
+    // pixels from either edge of the line in every mode, so the lead never
+    // reaches into horizontal blanking.
+    localparam MEM_LAT = `MEM_LATENCY;  // Extra frame memory read latency (clocks)
+    localparam FETCH_LEAD = MEM_LAT * PPC;
+
+    // Step 1: Bounds check against the display window. x_px/y_px are
+    // registered from hc/vc, so they are valid one clock after activevideo.
+    // During blanking they wrap modulo 2^WIDTH, and in XGA the wrapped
+    // horizontal blanking values (704-895) land inside the display window;
+    // coords_valid keeps those clocks out of the display area.
+    reg                      coords_valid;
+`ifdef VGA_TIMING_REGS
+    // The old mode's last pixel must not be placed with the new geometry
+    always @(posedge px_clk) coords_valid <= (reset || timing_load) ? 1'b0 : activevideo;
+`else
+    always @(posedge px_clk) coords_valid <= reset ? 1'b0 : activevideo;
+`endif
+`ifdef NYANCAT_FRAME_VBLANK
     /* verilator lint_off WIDTHEXPAND */
-    wire                     in_display_x = (x_px >= OFFSET_X) && (x_px < OFFSET_X + SCALED_W);
+    assign vblank_start = coords_valid && !activevideo && (y_px == V_ACTIVE - 1);
     /* verilator lint_on WIDTHEXPAND */
+`endif
     /* verilator lint_off UNSIGNED */
-    wire                     in_display_y = (y_px >= OFFSET_Y) && (y_px < OFFSET_Y + SCALED_H);
+    /* verilator lint_off WIDTHEXPAND */
+    wire                     in_display_y = (y_px >= OFFSET_Y) && (y_px < OFFSET_Y + scaled_h);
+    /* verilator lint_on WIDTHEXPAND */
     /* verilator lint_on UNSIGNED */
-    wire                     in_display = in_display_x && in_display_y;
 
-    // Relative coordinates (valid only when in_display is high)
+    // Relative row (valid only when in_display is high); only the assertions
+    // use it, the datapath works from the counters below
     /* verilator lint_off WIDTHTRUNC */
-    wire [X_COORD_WIDTH-1:0] rel_x = x_px - OFFSET_X;
     wire [Y_COORD_WIDTH-1:0] rel_y = y_px - OFFSET_Y;
     /* verilator lint_on WIDTHTRUNC */
 
-    // Step 2: Descale coordinates by SCALE factor to map to source frame [0,63]
-    // Division by constant SCALE - synthesis tools optimize to efficient hardware
-    // (bit-shifts for power-of-2, shift-add sequences for other values)
+    // Step 2: Source coordinates src = rel / SCALE as DDA-style counters
+    // A constant divide by a non-power-of-2 SCALE (7, 9, 12) would put a
+    // divider on the pixel-clock critical path. Instead, sub_x counts pixels
+    // within a source pixel and steps src_x every SCALE pixels; sub_y/src_y
+    // do the same per line. Both are (re)started one clock ahead of the first
+    // display clock of each line (x_px == x_line_start), so (src_x, sub_x)
+    // equal lane 0's rel / SCALE and rel % SCALE on every display clock.
+    //
+    // With PPC=2 lane 0 can be one pixel left of the window on the first
+    // display clock (LANE0_LEAD); its counters then start at -1, i.e.
+    // (63, SCALE-1), and lane l adds l to sub_x with a carry into src_x.
+    //
+    // LANE0_LEAD depends on OFFSET_X only through its parity with PPC=2,
+    // which VGA_TIMING_REGS does not support, so it stays a constant.
+    localparam SUB_W = $clog2(SCALE_MAX);
+    localparam LANE0_LEAD = (OFFSET_X - LANE_SKEW - FETCH_LEAD) % PPC;
+    localparam [5:0] SRC_X_START = (LANE0_LEAD != 0) ? 63 : 0;
+    localparam [SUB_W-1:0] SUB_STEP = PPC;  // Pixels per clock
     /* verilator lint_off WIDTHTRUNC */
-    wire [              5:0] src_x = rel_x / SCALE, src_y = rel_y / SCALE;
+    /* verilator lint_off WIDTHEXPAND */
+    wire [SUB_W-1:0] sub_x_start = (LANE0_LEAD != 0) ? scale - LANE0_LEAD : 0;
+    wire [SUB_W-1:0] sub_wrap = scale - PPC;  // sub_x at or past this carries
+    wire [X_COORD_WIDTH-1:0] x_line_start =
+        offset_x - (LANE_SKEW + FETCH_LEAD + LANE0_LEAD + PPC);
+    /* verilator lint_on WIDTHEXPAND */
     /* verilator lint_on WIDTHTRUNC */
 
-    // Step 3: Calculate ROM address using frame index and source coordinates
-    // Formula: addr = (frame_index * FRAME_W * FRAME_H) + (src_y * FRAME_W) + src_x
-    // Synthesis tools automatically optimize multiplies by power-of-2 constants
-    // into shift operations, so explicit bit manipulation is unnecessary
-    localparam FRAME_SIZE = FRAME_W * FRAME_H;  // 4096 4-bit entries (2048 bytes)
+    reg [SUB_W-1:0] sub_x, sub_y;  // Position within the current source pixel
+    reg [5:0] src_x, src_y;  // Source frame coordinates [0,63] (lane 0)
+    wire line_start = (x_px == x_line_start);
+
     /* verilator lint_off WIDTHEXPAND */
-    wire [FRAME_ADDR_W-1:0] frame_addr = (frame_index * FRAME_SIZE) + (src_y * FRAME_W) + src_x;
+    always @(posedge px_clk) begin
+        if (reset) begin
+            sub_x <= 0;
+            src_x <= 0;
+            sub_y <= 0;
+            src_y <= 0;
+        end else if (line_start) begin
+            sub_x <= sub_x_start;
+            src_x <= SRC_X_START;
+            if (y_px == OFFSET_Y) begin
+                sub_y <= 0;  // First display line
+                src_y <= 0;
+            end else if (sub_y == scale - 1) begin
+                sub_y <= 0;
+                src_y <= src_y + 1;
+            end else begin
+                sub_y <= sub_y + 1;
+            end
+        end else if (sub_x >= sub_wrap) begin
+            sub_x <= sub_x - sub_wrap;
+            src_x <= src_x + 1;
+        end else begin
+            sub_x <= sub_x + SUB_STEP;
+        end
+    end
     /* verilator lint_on WIDTHEXPAND */
 
+    // Step 3: Per-lane display flag, source column, frame and ROM address
+    // addr = frame * FRAME_SIZE + src_y * FRAME_W + src_x; with 64×64 frames
+    // every term is a power of two, so the address is a plain concatenation
+    // (no multiplier, no adder).
+    //
+    // Lane l addresses the pixel a PPC=1, MEM_LAT=0 core would address
+    // FRAME_AHEAD+l pixel clocks from now, so on the clocks just before an
+    // animation step the later lanes already take next_index, as that core
+    // would.
+    localparam FRAME_SIZE = FRAME_W * FRAME_H;  // 4096 4-bit entries (2048 bytes)
+    localparam FRAME_AHEAD = LANE_SKEW + FETCH_LEAD - (PPC - 1);
+
+    wire [PPC-1:0] in_display;  // Lane pixel inside the animation area
+    wire [X_COORD_WIDTH:0] lane_x[0:PPC-1];  // Lane pixel X (one extra bit, no wrap)
+    wire [X_COORD_WIDTH-1:0] rel_x[0:PPC-1];  // Lane X relative to the window
+    wire [5:0] lane_src_x[0:PPC-1];  // Lane source column
+    wire [3:0] lane_frame[0:PPC-1];  // Lane frame index
+    wire [FRAME_ADDR_W-1:0] frame_addr[0:PPC-1];  // Lane ROM address
+
+    genvar l;
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane
+            /* verilator lint_off WIDTHEXPAND */
+            /* verilator lint_off WIDTHTRUNC */
+            assign lane_x[l] = x_px + LANE_SKEW + FETCH_LEAD + l;
+            assign rel_x[l] = lane_x[l] - offset_x;
+            assign in_display[l] = (lane_x[l] >= offset_x) && (lane_x[l] < offset_x + scaled_w) &&
+                in_display_y && coords_valid;
+            assign lane_src_x[l] = (sub_x + l >= scale) ? src_x + 1 : src_x;
+`ifdef NYANCAT_FRAME_DELTA
+            assign lane_frame[l] = show_frame;  // Changes in vertical blanking only
+`elsif NYANCAT_FRAME_VSYNC
+            assign lane_frame[l] = frame_index;  // Changes in vertical blanking only
+`else
+            assign lane_frame[l] =
+                (frame_counter + FRAME_AHEAD + l >= FRAME_PERIOD) ? next_index : frame_index;
+`endif
+            /* verilator lint_on WIDTHTRUNC */
+            /* verilator lint_on WIDTHEXPAND */
+            assign frame_addr[l] = {lane_frame[l], src_y, lane_src_x[l]};
+        end
+    endgenerate
+
     // =========================================================================
     // Memory Storage (abstracted interface for future bus protocol support)
     // =========================================================================
 
     // Frame data: 4-bit character indices (0-13) for all animation frames
     // Organized as: frame[0] (4096 entries), frame[1] (4096 entries), ..., frame[11]
-    // Memory interface: ROM (current), future: Wishbone/AXI
+    // Memory interface: ROM, or Wishbone (NYANCAT_FRAME_MEM_WB, data held by
+    // the bus slave). With NYANCAT_FRAME_RLE or NYANCAT_FRAME_DELTA the
+    // hardware has no frame_mem; simulation keeps it to check the decoded
+    // characters against (Assertions 14 and 15).
+`ifndef NYANCAT_FRAME_MEM_WB
+`ifdef NYANCAT_FRAME_ENCODED
+`ifndef SYNTHESIS
+    reg [`FRAME_MEM_DATA_WIDTH-1:0] frame_mem[0:(NUM_FRAMES * FRAME_W * FRAME_H)-1];
+`endif
+`else
     reg [`FRAME_MEM_DATA_WIDTH-1:0] frame_mem[0:(NUM_FRAMES * FRAME_W * FRAME_H)-1];
+`endif
+`endif
+
+`ifdef NYANCAT_FRAME_RLE
+    // Run-length frame ROM: rle_mem holds {run length - 1, character}
+    // words, rle_index the first word of each {frame, row}
+    localparam RLE_AW = `NYANCAT_RLE_ADDR_WIDTH;
+    reg [7:0] rle_mem[0:`NYANCAT_RLE_WORDS-1];
+    reg [RLE_AW-1:0] rle_index[0:NUM_FRAMES*FRAME_H-1];
+`endif
+
+`ifdef NYANCAT_FRAME_DELTA
+    // Delta frames: frame_buf starts as the keyframe (frame 0); delta_mem
+    // holds {pixel address, character} words, list f (frame f to f+1) from
+    // delta_index[f] to delta_index[f+1]-1
+    localparam DL_AW = `NYANCAT_DELTA_ADDR_WIDTH;
+    reg [`FRAME_MEM_DATA_WIDTH-1:0] frame_buf[0:FRAME_SIZE-1];
+    reg [15:0] delta_mem[0:`NYANCAT_DELTA_WORDS-1];
+    reg [DL_AW-1:0] delta_index[0:NUM_FRAMES];
+`endif
 
     // Color palette: 14 VGA colors encoded as 6-bit RRGGBB
     // Memory interface: ROM (current), future: Wishbone/AXI
     reg [`PALETTE_MEM_DATA_WIDTH-1:0] color_mem[0:15];
 
     // Load pre-generated animation data using abstract memory interface
+`ifdef NYANCAT_FRAME_RLE
+    `MEM_INIT(rle_mem, "nyancat-rle.hex")
+    `MEM_INIT(rle_index, "nyancat-rle-index.hex")
+`elsif NYANCAT_FRAME_DELTA
+    `MEM_INIT(frame_buf, "nyancat-key.hex")
+    `MEM_INIT(delta_mem, "nyancat-delta.hex")
+    `MEM_INIT(delta_index, "nyancat-delta-index.hex")
+`endif
+`ifndef NYANCAT_FRAME_MEM_WB
+`ifdef NYANCAT_FRAME_ENCODED
+`ifndef SYNTHESIS
     `MEM_INIT(frame_mem, "nyancat-frames.hex")
+`endif
+`else
+    `MEM_INIT(frame_mem, "nyancat-frames.hex")
+`endif
+`endif
     `MEM_INIT(color_mem, "nyancat-colors.hex")
 
+`ifndef NYANCAT_FRAME_MEM_WB
+    // Lane character at frame_addr, registered where it is used (prefetch
+    // delay line or pipeline stage 1): a frame_mem read, or a row buffer
+    // (NYANCAT_FRAME_RLE) or frame buffer (NYANCAT_FRAME_DELTA) read
+    wire [`FRAME_MEM_DATA_WIDTH-1:0] frame_rd[0:PPC-1];
+
+`ifdef NYANCAT_FRAME_RLE
+    // =========================================================================
+    // Row Decoder (NYANCAT_FRAME_RLE)
+    // =========================================================================
+    // Frame characters are read from two 64-entry row buffers, each tagged
+    // with the source row and frame it holds. After the last pixel of a line
+    // (x_px == X_DECODE) the decoder expands the row the next line shows,
+    // one character per clock, into a buffer whose row is no longer needed:
+    // for frame_index, and for next_index too while an animation step may
+    // land before that line ends (then its later pixels show the new frame).
+    // A row already held is not decoded again, so each source row is decoded
+    // about once per animation frame rather than once per scanline.
+    //
+    // A decode takes FRAME_W + 1 clocks (index read, first word, one clock
+    // per character); two fit in horizontal blanking in every mode
+    // (Assertion 14). A buffer's tag is set when its decode starts: the
+    // decoder writes left to right, far ahead of the beam, which lets row 0
+    // be decoded right after reset while the first line is already running.
+
+    localparam [X_COORD_WIDTH-1:0] X_DECODE = ((OFFSET_X + SCALED_W + PPC - 1) / PPC) * PPC;
+    localparam [21:0] STEP_HORIZON = FRAME_PERIOD - (V_BLANK + 2) * H_TOTAL;
+    localparam [5:0] LAST_COL = FRAME_W - 1;
+
+    reg [`FRAME_MEM_DATA_WIDTH-1:0] row_buf[0:2*FRAME_W-1];  // Two row buffers, {buffer, column}
+    reg [1:0] rb_valid;  // Buffer tag below is valid
+    reg [5:0] rb_row[0:1];  // Source row held
+    reg [3:0] rb_frame[0:1];  // Frame the row belongs to
+
+    // Trigger: the next line is a display line; which row it shows
+    /* verilator lint_off WIDTHEXPAND */
+    /* verilator lint_off WIDTHTRUNC */
+    wire [Y_COORD_WIDTH-1:0] next_y = (y_px == V_ACTIVE - 1) ? 0 : y_px + 1;
+    /* verilator lint_off UNSIGNED */
+    wire next_in_display = (next_y >= OFFSET_Y) && (next_y < OFFSET_Y + SCALED_H);
+    /* verilator lint_on UNSIGNED */
+    wire [5:0] next_row = (next_y == OFFSET_Y) ? 0 : (sub_y == SCALE - 1) ? src_y + 1 : src_y;
+    /* verilator lint_on WIDTHTRUNC */
+    /* verilator lint_on WIDTHEXPAND */
+`ifdef NYANCAT_FRAME_VSYNC
+    // Steps land at vblank_start, after the last line's trigger; decode row 0
+    // of next_index there too if one is pending or may still come due
+    /* verilator lint_off WIDTHEXPAND */
+    wire step_near = (y_px == V_ACTIVE - 1) && (step_pending || frame_counter >= STEP_HORIZON);
+    /* verilator lint_on WIDTHEXPAND */
+`else
+    wire step_near = (frame_counter >= STEP_HORIZON);  // Step may land before the next line ends
+`endif
+
+    reg dec_boot;  // Row 0 still to decode after reset (no trigger precedes line 0)
+    reg dec_busy, dec_fetch;  // Decoding a row / reading its first word
+    reg dec_buf;  // Buffer being written
+    reg [5:0] dec_row, dec_col;  // Row being decoded, next column written
+    reg dec_pend, dec_pend_buf;  // Second row (next_index) queued, its buffer
+    reg [3:0] dec_pend_frame;  // next_index at the trigger (a step may land meanwhile)
+    reg [RLE_AW-1:0] dec_ptr;  // Next rle_mem word
+    reg [7:0] dec_word;  // rle_mem word read last clock
+    reg dec_word_new;  // dec_word starts a run this clock
+    reg [3:0] dec_left, dec_char;  // Characters left in the current run, its character
+
+    wire dec_trigger = dec_boot || (coords_valid && x_px == X_DECODE && next_in_display);
+    wire dec_start = dec_trigger && !dec_busy;
+    wire [5:0] trig_row = dec_boot ? 6'd0 : next_row;
+    wire [1:0] hit_a, hit_b;  // Buffer already holds trig_row of frame_index / next_index
+
+    genvar b;
+    generate
+        for (b = 0; b < 2; b = b + 1) begin : rb_tag
+            assign hit_a[b] = rb_valid[b] && (rb_row[b] == trig_row) && (rb_frame[b] == frame_index);
+            assign hit_b[b] = rb_valid[b] && (rb_row[b] == trig_row) && (rb_frame[b] == next_index);
+        end
+    endgenerate
+
+    wire need_a = !(|hit_a);
+    wire need_b = step_near && !(|hit_b);
+    // Never overwrite the buffer holding the other row the next line needs
+    wire buf_a = step_near && hit_b[0];
+    wire buf_b = need_a || hit_a[0];
+
+    wire [3:0] run_char = dec_word_new ? dec_word[3:0] : dec_char;
+    wire [3:0] run_left = dec_word_new ? dec_word[7:4] : dec_left;
+
+    /* verilator lint_off WIDTHEXPAND */
+    always @(posedge px_clk) begin
+        if (reset) begin
+            rb_valid <= 0;
+            dec_boot <= 1;
+            dec_busy <= 0;
+            dec_pend <= 0;
+        end else if (dec_start && (need_a || need_b)) begin
+            // Start a row: look up its first word
+            dec_boot <= 0;
+            dec_busy <= 1;
+            dec_fetch <= 1;
+            dec_row <= trig_row;
+            dec_buf <= need_a ? buf_a : buf_b;
+            dec_ptr <= rle_index[{need_a ? frame_index : next_index, trig_row}];
+            dec_pend <= need_a && need_b;
+            dec_pend_buf <= buf_b;
+            dec_pend_frame <= next_index;
+            if (need_a) begin
+                rb_valid[buf_a] <= 1;
+                rb_row[buf_a]   <= trig_row;
+                rb_frame[buf_a] <= frame_index;
+            end else begin
+                rb_valid[buf_b] <= 1;
+                rb_row[buf_b]   <= trig_row;
+                rb_frame[buf_b] <= next_index;
+            end
+        end else if (dec_start) begin
+            dec_boot <= 0;  // Both rows already held
+        end else if (dec_busy && dec_fetch) begin
+            `MEM_READ(dec_word, rle_mem, dec_ptr);
+            dec_ptr <= dec_ptr + 1;
+            dec_word_new <= 1;
+            dec_fetch <= 0;
+            dec_col <= 0;
+        end else if (dec_busy) begin
+            // One character per clock; the next word is read as a run ends
+            row_buf[{dec_buf, dec_col}] <= run_char;
+            dec_char <= run_char;
+            dec_left <= run_left - 1;
+            dec_word_new <= (run_left == 0);
+            if (run_left == 0 && dec_col != LAST_COL) begin
+                `MEM_READ(dec_word, rle_mem, dec_ptr);
+                dec_ptr <= dec_ptr + 1;
+            end
+            dec_col <= dec_col + 1;
+            if (dec_col == LAST_COL) begin
+                if (dec_pend) begin
+                    // Same row of the following frame
+                    dec_fetch <= 1;
+                    dec_buf <= dec_pend_buf;
+                    dec_ptr <= rle_index[{dec_pend_frame, dec_row}];
+                    dec_pend <= 0;
+                    rb_valid[dec_pend_buf] <= 1;
+                    rb_row[dec_pend_buf]   <= dec_row;
+                    rb_frame[dec_pend_buf] <= dec_pend_frame;
+                end else begin
+                    dec_busy <= 0;
+                end
+            end
+        end
+    end
+    /* verilator lint_on WIDTHEXPAND */
+
+    // Lane read: the buffer tagged with the lane's row and frame
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_rle
+            wire sel = rb_valid[1] && (rb_row[1] == src_y) && (rb_frame[1] == lane_frame[l]);
+            assign frame_rd[l] = row_buf[{sel, lane_src_x[l]}];
+        end
+    endgenerate
+`elsif NYANCAT_FRAME_DELTA
+    // =========================================================================
+    // Frame Buffer (NYANCAT_FRAME_DELTA)
+    // =========================================================================
+    // Only the frame on screen is stored. frame_buf holds show_frame and is
+    // patched to the following frame by applying that step's delta list,
+    // one word per clock, during vertical blanking only. At the start of
+    // blanking (vblank_start) frame_index is latched as dl_target; lists are
+    // applied while show_frame lags dl_target and the next list fits in the
+    // blanking clocks left (dl_left), so a patch never overlaps the picture.
+    // The picture thus changes between video frames only, never mid-frame,
+    // and every lane uses show_frame (lane_frame), line buffer tags included.
+    //
+    // show_frame is not reset: after a reset mid-animation the buffer still
+    // holds show_frame and catches up with frame_index (cyclically) over the
+    // next blanking intervals.
+
+    localparam VBLANK_CLOCKS = V_BLANK * H_TOTAL / PPC;  // Full blanking lines after vblank_start
+    localparam DL_LEFT_W = $clog2(VBLANK_CLOCKS + 1);
+
+    reg [3:0] dl_target;  // frame_index at vblank_start: frame to show next
+    reg [DL_LEFT_W-1:0] dl_left;  // Blanking clocks left for patching
+    reg dl_busy;  // Applying a list
+    reg dl_wr;  // dl_word is written this clock
+    reg [DL_AW-1:0] dl_ptr, dl_end;  // Next word, end of the list
+    reg [15:0] dl_word;  // {pixel address, character} read last clock
+
+    wire [DL_AW-1:0] dl_first = delta_index[show_frame];
+    wire [DL_AW-1:0] dl_last = delta_index[show_frame+1];
+    /* verilator lint_off WIDTHEXPAND */
+    wire dl_fits = (dl_last - dl_first) + 3 <= dl_left;  // Start, words, final write
+    /* verilator lint_on WIDTHEXPAND */
+
+    /* verilator lint_off WIDTHEXPAND */
+    /* verilator lint_off WIDTHTRUNC */
+    always @(posedge px_clk) begin
+        if (reset) begin
+            dl_target <= 0;
+            dl_left <= 0;
+            dl_busy <= 0;
+            dl_wr <= 0;
+        end else begin
+            if (vblank_start) begin
+                dl_target <= frame_index;
+                dl_left <= VBLANK_CLOCKS - 1;
+            end else if (dl_left != 0) begin
+                dl_left <= dl_left - 1;
+            end
+
+            if (dl_wr) frame_buf[dl_word[15:4]] <= dl_word[3:0];
+
+            if (!dl_busy) begin
+                if (show_frame != dl_target && dl_fits) begin
+                    dl_busy <= 1;
+                    dl_ptr <= dl_first;
+                    dl_end <= dl_last;
+                end
+            end else if (dl_ptr != dl_end) begin
+                `MEM_READ(dl_word, delta_mem, dl_ptr);
+                dl_ptr <= dl_ptr + 1;
+                dl_wr <= 1;
+            end else begin
+                // Last word written this clock (dl_wr) or list done
+                dl_wr <= 0;
+                if (!dl_wr) begin
+                    dl_busy <= 0;
+                    show_frame <= (show_frame == NUM_FRAMES - 1) ? 0 : show_frame + 1;
+                end
+            end
+        end
+    end
+    /* verilator lint_on WIDTHTRUNC */
+    /* verilator lint_on WIDTHEXPAND */
+
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_dl
+            assign frame_rd[l] = frame_buf[{src_y, lane_src_x[l]}];
+        end
+    endgenerate
+`else
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_rd
+            assign frame_rd[l] = frame_mem[frame_addr[l]];
+        end
+    endgenerate
+`endif
+`endif
+
+    // =========================================================================
+    // ROM Read Enables
+    // =========================================================================
+    // ROMs are only read for pixels inside the display area (reads elsewhere
+    // were gated off at the output anyway). public_flat_rd: the simulator
+    // counts reads per frame from these (--profile-render). With
+    // NYANCAT_FRAME_RLE frame_rom_en counts row buffer reads.
+
+    wire [PPC-1:0] frame_rom_en  /* verilator public_flat_rd */;  // frame_mem read per lane
+    wire [PPC-1:0] palette_rom_en  /* verilator public_flat_rd */;  // color_mem read per lane
+
+`ifdef NYANCAT_FRAME_MEM_WB
+    wire frame_miss;  // Due character not back from the bus (Wishbone master below)
+`endif
+
+`ifdef NYANCAT_LINE_BUFFER
+    // =========================================================================
+    // Line Buffer
+    // =========================================================================
+    // A source row is displayed on SCALE consecutive scanlines. The first of
+    // them (fill line) reads both ROMs and writes each resulting color into
+    // line_buf[src_x]; the remaining SCALE-1 lines read line_buf instead, so
+    // ROM reads per frame drop by ~SCALE×.
+    //
+    // The buffer is tagged with the source row and frame_index it holds; a
+    // pixel only hits when both match. The tag is updated on the last pixel
+    // of each display line, and left invalid if frame_index changed during
+    // that line (partially refilled buffer). Output is therefore identical
+    // to the direct ROM path, including across mid-frame animation steps.
+    // With PPC=2 every lane has its own read and write port.
+
+    reg [`PALETTE_MEM_DATA_WIDTH-1:0] line_buf[0:FRAME_W-1];
+    reg lb_valid;  // Tag below describes the whole buffer
+    reg [5:0] lb_row;  // Source row held in line_buf
+    reg [3:0] lb_frame;  // frame_index the row was fetched with
+    reg [3:0] line_frame;  // frame_index at the first pixel of the current line
+`ifdef NYANCAT_FRAME_MEM_WB
+    reg line_missed;  // A fill read of the current line was missed
+`endif
+
+    wire [PPC-1:0] lb_hit;  // Lane pixel can be served from line_buf
+    wire [PPC-1:0] line_first_px, line_last_px;  // Lane shows the first/last display pixel
+
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_lb
+            assign lb_hit[l] = lb_valid && (lb_row == src_y) && (lb_frame == lane_frame[l]);
+            /* verilator lint_off WIDTHEXPAND */
+            assign line_first_px[l] = in_display[l] && (lane_x[l] == offset_x);
+            assign line_last_px[l] = in_display[l] && (lane_x[l] == offset_x + scaled_w - 1);
+            /* verilator lint_on WIDTHEXPAND */
+        end
+    endgenerate
+
+    integer tag_lane;
+    always @(posedge px_clk) begin
+        if (reset) begin
+            lb_valid <= 0;
+        end else begin
+            for (tag_lane = 0; tag_lane < PPC; tag_lane = tag_lane + 1) begin
+                if (line_first_px[tag_lane]) line_frame <= lane_frame[tag_lane];
+                if (line_last_px[tag_lane]) begin
+                    lb_valid <= (lane_frame[tag_lane] == line_frame);
+                    lb_row   <= src_y;
+                    lb_frame <= lane_frame[tag_lane];
+                end
+            end
+`ifdef NYANCAT_FRAME_MEM_WB
+            // A missed fill read leaves a stale entry: the row must not be
+            // tagged, or loses its tag if the miss comes due after the last
+            // pixel was issued (MEM_LAT > 0)
+            if (line_first_px[0]) line_missed <= 0;
+            if (line_last_px[0] && line_missed) lb_valid <= 0;
+            if (frame_miss) begin
+                line_missed <= 1;
+                lb_valid <= 0;
+            end
+`endif
+        end
+    end
+
+    assign frame_rom_en = in_display & ~lb_hit;
+`else
+    wire [PPC-1:0] lb_hit = {PPC{1'b0}};  // No line buffer
+
+    assign frame_rom_en = in_display;
+`endif
+
+    // =========================================================================
+    // Prefetch (MEM_LATENCY)
+    // =========================================================================
+    // Everything above works at issue time, MEM_LAT clocks ahead of the beam.
+    // Each lane's flags and source column go through a MEM_LAT-deep delay
+    // line and come out due on the clock a MEM_LAT=0 core would read the
+    // frame ROM; stage 1 of the pipeline below works on the due values. In
+    // between, frame memory has MEM_LAT extra clocks to return a character:
+    //   ROM build: frame_mem is read at issue and the character shifts
+    //     along with the flags (a block RAM with MEM_LAT output registers)
+    //   Wishbone build: the master below queues requests and responses
+    // With MEM_LAT=0 the due signals are the issue-time ones.
+
+    wire [PPC-1:0] in_display_due;  // Lane pixel inside the animation area
+    wire [PPC-1:0] lb_hit_due;  // Lane pixel served from line_buf
+    wire [PPC-1:0] frame_rom_due;  // Lane character due from frame memory
+    wire [5:0] src_x_due[0:PPC-1];  // Lane source column
+`ifndef NYANCAT_FRAME_MEM_WB
+    wire [`FRAME_MEM_DATA_WIDTH-1:0] char_due[0:PPC-1];  // Lane character read from frame_mem
+`endif
+
+    assign frame_rom_due = in_display_due & ~lb_hit_due;
+
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_pf
+            if (MEM_LAT == 0) begin : direct
+                assign in_display_due[l] = in_display[l];
+                assign lb_hit_due[l] = lb_hit[l];
+                assign src_x_due[l] = lane_src_x[l];
+`ifndef NYANCAT_FRAME_MEM_WB
+                assign char_due[l] = frame_rd[l];  // Registered by stage 1
+`endif
+            end else begin : delayed
+                reg [MEM_LAT-1:0] in_display_dl, lb_hit_dl;
+                reg [5:0] src_x_dl[0:MEM_LAT-1];
+`ifndef NYANCAT_FRAME_MEM_WB
+                reg [`FRAME_MEM_DATA_WIDTH-1:0] char_dl[0:MEM_LAT-1];
+`endif
+                integer d;
+
+                always @(posedge px_clk) begin
+                    if (reset) begin
+                        in_display_dl <= 0;
+                        lb_hit_dl <= 0;
+                    end else begin
+                        in_display_dl[0] <= in_display[l];
+                        lb_hit_dl[0] <= lb_hit[l];
+                        src_x_dl[0] <= lane_src_x[l];
+`ifndef NYANCAT_FRAME_MEM_WB
+                        if (frame_rom_en[l]) char_dl[0] <= frame_rd[l];
+`endif
+                        for (d = 1; d < MEM_LAT; d = d + 1) begin
+                            in_display_dl[d] <= in_display_dl[d-1];
+                            lb_hit_dl[d] <= lb_hit_dl[d-1];
+                            src_x_dl[d] <= src_x_dl[d-1];
+`ifndef NYANCAT_FRAME_MEM_WB
+                            char_dl[d] <= char_dl[d-1];
+`endif
+                        end
+                    end
+                end
+
+                assign in_display_due[l] = in_display_dl[MEM_LAT-1];
+                assign lb_hit_due[l] = lb_hit_dl[MEM_LAT-1];
+                assign src_x_due[l] = src_x_dl[MEM_LAT-1];
+`ifndef NYANCAT_FRAME_MEM_WB
+                assign char_due[l] = char_dl[MEM_LAT-1];
+`endif
+            end
+        end
+    endgenerate
+
+`ifdef NYANCAT_FRAME_MEM_WB
+    // =========================================================================
+    // Wishbone Frame Memory Master
+    // =========================================================================
+    // Each frame read becomes a single-beat Wishbone request (wb_stb_o with
+    // the ROM address) at issue time, MEM_LAT clocks before its character is
+    // due. Requests wait in req_fifo while the slave stalls; acknowledged
+    // characters wait in rsp_fifo until due, and an acknowledge on the due
+    // clock itself is used directly. The slave may therefore spend up to
+    // MEM_LAT clocks per read on stalls plus wait states (MEM_LAT=0: it must
+    // accept and acknowledge in the request's own clock, the ROM latency).
+    //
+    // A character not back by its due clock is a miss: frame_miss pulses,
+    // char_idx_q keeps the previous character and frame_misses counts it.
+    // A request presented while wb_stall_i is high stays on the bus unchanged
+    // until the slave accepts it (Wishbone B4 pipelined): it moves into the
+    // bus_held register and wb_stb_o/wb_adr_o come from there. A missed
+    // request that was presented (held, or on the bus in its due clock) is
+    // marked dead and still completes; its late acknowledge is dropped
+    // (wb_drop), so the in-order responses stay matched to their pixels. Only
+    // a read that was never presented (waiting in req_fifo, or new, behind a
+    // dead held request) is withdrawn.
+
+    localparam PF_AW = (MEM_LAT < 1) ? 1 : $clog2(MEM_LAT + 1);  // FIFO pointer width
+    localparam PF_DEPTH = 1 << PF_AW;  // Holds the MEM_LAT+1 reads in flight
+
+    reg [`FRAME_MEM_ADDR_WIDTH-1:0] req_fifo[0:PF_DEPTH-1];  // Issued, not yet accepted
+    reg [`FRAME_MEM_DATA_WIDTH-1:0] rsp_fifo[0:PF_DEPTH-1];  // Acknowledged, not yet due
+    reg [PF_AW-1:0] req_rd, req_wr, rsp_rd, rsp_wr;
+    reg [PF_AW:0] req_count, rsp_count;
+    reg [7:0] wb_issued, wb_acked;  // Requests accepted / acknowledged (mod 256)
+    reg [7:0] pf_gone, pf_due;  // Reads accepted, dead or withdrawn / come due (mod 256)
+    reg [7:0] wb_drop;  // Acknowledges still owed to missed pixels
+    reg [31:0] frame_misses  /* verilator public_flat_rd */;  // Missed characters since reset
+    reg bus_held, bus_dead;  // Stalled request held on the bus / already missed
+    reg [`FRAME_MEM_ADDR_WIDTH-1:0] bus_adr;
+
+    wire req_queued = (req_count != 0);
+    assign wb_stb_o = bus_held || req_queued || frame_rom_en[0];
+    assign wb_cyc_o = wb_stb_o || (wb_issued != wb_acked);
+    assign wb_we_o  = 1'b0;
+    assign wb_adr_o = bus_held ? bus_adr : req_queued ? req_fifo[req_rd] : frame_addr[0];
+    wire wb_accept = wb_stb_o && !wb_stall_i;
+    wire wb_hold = wb_stb_o && wb_stall_i;  // Presented, must stay next clock
+    wire live_accept = wb_accept && !(bus_held && bus_dead);
+
+    // Presented from req_fifo's head or as this clock's new read
+    wire present_head = !bus_held && req_queued;
+    wire present_new = !bus_held && !req_queued && frame_rom_en[0];
+
+    // Due side: oldest queued character, else an acknowledge this clock
+    wire rsp_queued = (rsp_count != 0);
+    wire ack_live = wb_ack_i && (wb_drop == 0);  // Not owed to a missed pixel
+    wire pf_hit = rsp_queued || ack_live;
+    wire [`FRAME_MEM_DATA_WIDTH-1:0] pf_data = rsp_queued ? rsp_fifo[rsp_rd] : wb_dat_i;
+    assign frame_miss = frame_rom_due[0] && !pf_hit;
+
+    // The due read is the oldest one not yet accepted, dead or withdrawn when
+    // pf_gone == pf_due. It is then on the bus (held, req_fifo's head or this
+    // clock's new read when MEM_LAT=0) unless a dead request is held, in
+    // which case it is the next one and was never presented.
+    wire due_waiting = frame_miss && (pf_gone == pf_due) && !live_accept;
+    wire withdraw = due_waiting && bus_held && bus_dead;
+    wire mark_dead = due_waiting && !withdraw;
+    wire drop_add = frame_miss && !withdraw;
+    wire ack_drop = wb_ack_i && (wb_drop != 0);
+
+    wire req_push = frame_rom_en[0] && !present_new && !(withdraw && !req_queued);
+    wire req_pop = present_head || (withdraw && req_queued);
+    wire rsp_push = ack_live && !(frame_rom_due[0] && !rsp_queued);
+    wire rsp_pop = frame_rom_due[0] && rsp_queued;
+
+    /* verilator lint_off WIDTHEXPAND */
+    always @(posedge px_clk) begin
+        if (reset) begin
+            req_rd <= 0;
+            req_wr <= 0;
+            req_count <= 0;
+            rsp_rd <= 0;
+            rsp_wr <= 0;
+            rsp_count <= 0;
+            wb_issued <= 0;
+            wb_acked <= 0;
+            pf_gone <= 0;
+            pf_due <= 0;
+            wb_drop <= 0;
+            frame_misses <= 0;
+            bus_held <= 0;
+            bus_dead <= 0;
+        end else begin
+            if (req_push) begin
+                req_fifo[req_wr] <= frame_addr[0];
+                req_wr <= req_wr + 1;
+            end
+            if (req_pop) req_rd <= req_rd + 1;
+            req_count <= req_count + req_push - req_pop;
+
+            if (rsp_push) begin
+                rsp_fifo[rsp_wr] <= wb_dat_i;
+                rsp_wr <= rsp_wr + 1;
+            end
+            if (rsp_pop) rsp_rd <= rsp_rd + 1;
+            rsp_count <= rsp_count + rsp_push - rsp_pop;
+
+            if (wb_accept) wb_issued <= wb_issued + 1;
+            if (wb_ack_i) wb_acked <= wb_acked + 1;
+            if (live_accept || mark_dead || withdraw) pf_gone <= pf_gone + 1;
+            if (frame_rom_due[0]) pf_due <= pf_due + 1;
+            wb_drop <= wb_drop + drop_add - ack_drop;
+            if (frame_miss) frame_misses <= frame_misses + 1;
+
+            // Stalled request: keep it on the bus until accepted
+            if (bus_held) begin
+                if (wb_accept) bus_held <= 0;
+                else if (mark_dead) bus_dead <= 1;
+            end else if (wb_hold) begin
+                bus_held <= 1;
+                bus_adr  <= wb_adr_o;
+                bus_dead <= mark_dead;
+            end
+        end
+    end
+    /* verilator lint_on WIDTHEXPAND */
+`endif
+
     // =========================================================================
     // 2-Stage Pipeline for Memory Read Latency
     // =========================================================================
@@ -141,28 +953,64 @@ module nyancat (
     // Stage 1: Read character index from frame memory using computed address
     // Stage 2: Read final color from palette memory using character index
     // Both stages must propagate the in_display flag to maintain sync with data.
+    // Each lane has its own pipeline (with PPC=2 both ROMs are read through
+    // two ports, as a dual-port block RAM provides).
     //
     // Note: This pipeline structure remains compatible with future bus protocols
     // (Wishbone/AXI) that also have 1-cycle read latency.
 
-    reg [`FRAME_MEM_DATA_WIDTH-1:0] char_idx_q;  // Stage 1 output: Character index
-    reg in_display_q, in_display_q2;  // Display area flag pipelined through both stages
-    reg [`PALETTE_MEM_DATA_WIDTH-1:0] color_q;  // Stage 2 output: Final color value
+    reg [`FRAME_MEM_DATA_WIDTH-1:0] char_idx_q[0:PPC-1];  // Stage 1 output: Character index
+    reg [PPC-1:0] in_display_q, in_display_q2;  // Display area flags pipelined through both stages
+    reg [`PALETTE_MEM_DATA_WIDTH-1:0] color_q[0:PPC-1];  // Stage 2 output: Final color value
+
+`ifdef NYANCAT_LINE_BUFFER
+    reg [PPC-1:0] lb_hit_q, lb_hit_q2;  // Pixel served from line_buf, per stage
+    reg [5:0] src_x_q[0:PPC-1], src_x_q2[0:PPC-1];  // line_buf index, per stage
+    reg [`PALETTE_MEM_DATA_WIDTH-1:0] lb_color_q[0:PPC-1];  // Stage 1 output on a hit
+
+    assign palette_rom_en = in_display_q & ~lb_hit_q;
+`else
+    assign palette_rom_en = in_display_q;
+`endif
 
     // Pipeline datapath: Memory addressing → char lookup → color lookup
     // Note: Reset values omitted for datapath registers - in_display flags
     // ensure correct output gating regardless of pipeline register contents
+    integer pipe_lane;
     always @(posedge px_clk) begin
         if (reset) begin
             in_display_q  <= 0;
             in_display_q2 <= 0;
         end else begin
-            // Stage 1: Fetch character index using abstract memory interface
-            `MEM_READ(char_idx_q, frame_mem, frame_addr);
-            in_display_q <= in_display;
-            // Stage 2: Fetch final color using abstract memory interface
-            `MEM_READ(color_q, color_mem, char_idx_q);
+            in_display_q  <= in_display_due;
             in_display_q2 <= in_display_q;
+`ifdef NYANCAT_LINE_BUFFER
+            lb_hit_q  <= in_display_due & lb_hit_due;
+            lb_hit_q2 <= lb_hit_q;
+`endif
+            for (pipe_lane = 0; pipe_lane < PPC; pipe_lane = pipe_lane + 1) begin
+                // Stage 1: Take the character index read from frame memory
+`ifdef NYANCAT_FRAME_MEM_WB
+                if (frame_rom_due[pipe_lane] && pf_hit) char_idx_q[pipe_lane] <= pf_data;
+`else
+                if (frame_rom_due[pipe_lane]) char_idx_q[pipe_lane] <= char_due[pipe_lane];
+`endif
+                // Stage 2: Fetch final color using abstract memory interface
+                if (palette_rom_en[pipe_lane])
+                    `MEM_READ(color_q[pipe_lane], color_mem, char_idx_q[pipe_lane]);
+`ifdef NYANCAT_LINE_BUFFER
+                // Hit path: line_buf read in stage 1, forwarded in stage 2
+                if (in_display_due[pipe_lane] && lb_hit_due[pipe_lane])
+                    lb_color_q[pipe_lane] <= line_buf[src_x_due[pipe_lane]];
+                if (in_display_q[pipe_lane] && lb_hit_q[pipe_lane])
+                    color_q[pipe_lane] <= lb_color_q[pipe_lane];
+                src_x_q[pipe_lane]  <= src_x_due[pipe_lane];
+                src_x_q2[pipe_lane] <= src_x_q[pipe_lane];
+                // Fill path: store each ROM-fetched color once stage 2 has it
+                if (in_display_q2[pipe_lane] && !lb_hit_q2[pipe_lane])
+                    line_buf[src_x_q2[pipe_lane]] <= color_q[pipe_lane];
+`endif
+            end
         end
     end
 
@@ -172,7 +1020,11 @@ module nyancat (
     // Output color only during active video region and when pixel is within
     // the animation display area. Output black (6'b0) for all other pixels.
 
-    assign rrggbb = (activevideo && in_display_q2) ? color_q : 6'b0;
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_out
+            assign rrggbb[6*l+:6] = (activevideo && in_display_q2[l]) ? color_q[l] : 6'b0;
+        end
+    endgenerate
 
     // =========================================================================
     // Verification Assertions (Verilator simulation only)
@@ -186,11 +1038,11 @@ module nyancat (
     always @(posedge px_clk) past_valid <= 1;
 
     // Assertion 1: Pipeline stage 1 propagates in_display correctly
-    // in_display_q should always match the previous cycle's in_display
+    // in_display_q should always match the previous cycle's in_display_due
     // Guard with !$past(reset) to avoid false positives during reset release
     always @(posedge px_clk)
         if (past_valid && !reset && !$past(reset)) begin
-            if (in_display_q !== $past(in_display))
+            if (in_display_q !== $past(in_display_due))
                 $error("[ASSERTION FAILED] Pipeline stage 1: in_display_q mismatch");
         end
 
@@ -206,6 +1058,8 @@ module nyancat (
     // Assertion 3: Coordinate bounds check during active display
     // Note: activevideo is combinational from vga_sync_gen, while x_px/y_px are registered
     // Check against previous cycle's activevideo to account for timing skew
+    // (with VGA_TIMING_REGS the bounds are vga_sync_gen's, checked there)
+`ifndef VGA_TIMING_REGS
     /* verilator lint_off WIDTHEXPAND */
     always @(posedge px_clk)
         if (past_valid && !reset && $past(activevideo)) begin
@@ -215,6 +1069,7 @@ module nyancat (
                 $error("[ASSERTION FAILED] y_px=%0d exceeds V_ACTIVE=%0d", y_px, V_ACTIVE);
         end
     /* verilator lint_on WIDTHEXPAND */
+`endif
 
     // Assertion 4: Frame index must stay within valid range [0, 11]
     always @(posedge px_clk)
@@ -227,105 +1082,350 @@ module nyancat (
                 );
         end
 
-    // Assertion 5: Character index should be valid (0-13) when in display
-    // Note: Index 14-15 are unused but not errors (palette has 16 entries)
-    // Guard with !$past(reset) and !$isunknown to avoid spurious warnings
-    always @(posedge px_clk)
-        if (past_valid && !reset && !$past(
-                reset
-            ) && $past(
-                in_display
-            ) && !$isunknown(
-                char_idx_q
-            )) begin
-            if (char_idx_q > 13)
-                $warning(
-                    "[ASSERTION WARNING] char_idx_q=%0d uses reserved palette entry", char_idx_q
-                );
+    // Assertions 5-11 check each pixel lane
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_check
+            // Assertion 5: Character index should be valid (0-13) when in display
+            // Note: Index 14-15 are unused but not errors (palette has 16 entries)
+            // Guard with !$past(reset) and !$isunknown to avoid spurious warnings
+            always @(posedge px_clk)
+                if (past_valid && !reset && !$past(
+                        reset
+                    ) && $past(
+                        in_display_due[l]
+                    ) && !$isunknown(
+                        char_idx_q[l]
+                    )) begin
+                    if (char_idx_q[l] > 13)
+                        $warning(
+                            "[ASSERTION WARNING] lane %0d char_idx_q=%0d uses reserved palette entry",
+                            l,
+                            char_idx_q[l]
+                        );
+                end
+
+            // Assertion 6: ROM address must stay within allocated memory bounds
+            // Check both current cycle (defensive) and previous cycle (actual ROM read timing)
+            always @(posedge px_clk)
+                if (!reset && in_display[l]) begin
+                    if (frame_addr[l] >= NUM_FRAMES * FRAME_SIZE)
+                        $error(
+                            "[ASSERTION FAILED] lane %0d frame_addr=%0d exceeds ROM size=%0d",
+                            l,
+                            frame_addr[l],
+                            NUM_FRAMES * FRAME_SIZE
+                        );
+                end
+
+            // Assertion 7: ROM address timing alignment (check at actual cycle of use)
+            // frame_addr from previous cycle is what gets read into char_idx_q this cycle
+            always @(posedge px_clk)
+                if (past_valid && !reset && !$past(reset) && $past(in_display[l])) begin
+                    if ($past(frame_addr[l]) >= NUM_FRAMES * FRAME_SIZE)
+                        $error(
+                            "[ASSERTION FAILED] lane %0d ROM read with frame_addr=%0d exceeds size=%0d",
+                            l,
+                            $past(
+                                frame_addr[l]
+                            ),
+                            NUM_FRAMES * FRAME_SIZE
+                        );
+                end
+
+            // Assertion 8: Output alignment - verify rrggbb matches pipeline correctly
+            // rrggbb is combinational: lane = (activevideo && in_display_q2) ? color_q : 6'b0
+            // Check current cycle's activevideo and in_display_q2 against current rrggbb
+            always @(posedge px_clk)
+                if (past_valid && !reset && !$past(reset)) begin
+                    if (activevideo && in_display_q2[l]) begin
+                        if (rrggbb[6*l+:6] !== color_q[l])
+                            $error(
+                                "[ASSERTION FAILED] Output misalignment: lane %0d rrggbb=%h should match color_q=%h",
+                                l,
+                                rrggbb[6*l+:6],
+                                color_q[l]
+                            );
+                    end else begin
+                        if (rrggbb[6*l+:6] !== 6'b0)
+                            $error(
+                                "[ASSERTION FAILED] Output should be zero outside display, lane %0d got rrggbb=%h",
+                                l,
+                                rrggbb[6*l+:6]
+                            );
+                    end
+                end
+
+            // Assertion 9: Coordinate transformation validity (defense-in-depth)
+            // When in_display=1, verify that coordinate transformations are correct:
+            // - src_x and src_y must be within [0, FRAME_W-1] and [0, FRAME_H-1]
+            // - rel_x and rel_y must be within [0, SCALED_W-1] and [0, SCALED_H-1]
+            // This prevents wild pointer crashes in framebuffer updates
+            /* verilator lint_off WIDTHEXPAND */
+            always @(posedge px_clk)
+                if (past_valid && !reset && !$past(reset) && in_display[l]) begin
+                    if (lane_src_x[l] >= FRAME_W)
+                        $error(
+                            "[ASSERTION FAILED] lane %0d src_x=%0d exceeds FRAME_W=%0d (in_display=1)",
+                            l,
+                            lane_src_x[l],
+                            FRAME_W
+                        );
+                    if (src_y >= FRAME_H)
+                        $error(
+                            "[ASSERTION FAILED] src_y=%0d exceeds FRAME_H=%0d (in_display=1)",
+                            src_y,
+                            FRAME_H
+                        );
+                    if (rel_x[l] >= scaled_w)
+                        $error(
+                            "[ASSERTION FAILED] lane %0d rel_x=%0d exceeds SCALED_W=%0d (in_display=1)",
+                            l,
+                            rel_x[l],
+                            scaled_w
+                        );
+                    if (rel_y >= scaled_h)
+                        $error(
+                            "[ASSERTION FAILED] rel_y=%0d exceeds SCALED_H=%0d (in_display=1)",
+                            rel_y,
+                            scaled_h
+                        );
+                end
+            /* verilator lint_on WIDTHEXPAND */
+
+`ifdef NYANCAT_LINE_BUFFER
+`ifndef NYANCAT_FRAME_MEM_WB
+            // Assertion 10: A line buffer hit must return what the ROM path would
+            // (catches stale tags, e.g. across a mid-line frame_index change)
+            always @(posedge px_clk)
+                if (!reset && in_display[l] && lb_hit[l]) begin
+                    if (line_buf[lane_src_x[l]] !== color_mem[frame_mem[frame_addr[l]]])
+                        $error(
+                            "[ASSERTION FAILED] lane %0d line_buf[%0d]=%h != ROM color %h (row %0d)",
+                            l,
+                            lane_src_x[l],
+                            line_buf[lane_src_x[l]],
+                            color_mem[frame_mem[frame_addr[l]]],
+                            src_y
+                        );
+                end
+`endif
+`endif
+
+            // Assertion 11: DDA counters must match the divide-by-SCALE transform
+            // (the reference model still divides, so lockstep checks this as well)
+            /* verilator lint_off WIDTHEXPAND */
+            always @(posedge px_clk)
+                if (!reset && in_display[l]) begin
+                    if (lane_src_x[l] != rel_x[l] / scale || src_y != rel_y / scale)
+                        $error(
+                            "[ASSERTION FAILED] lane %0d src=(%0d,%0d) should be rel/SCALE=(%0d,%0d)",
+                            l,
+                            lane_src_x[l],
+                            src_y,
+                            rel_x[l] / scale,
+                            rel_y / scale
+                        );
+                end
+            /* verilator lint_on WIDTHEXPAND */
         end
+    endgenerate
 
-    // Assertion 6: ROM address must stay within allocated memory bounds
-    // Check both current cycle (defensive) and previous cycle (actual ROM read timing)
+`ifdef NYANCAT_FRAME_MEM_WB
+    // Assertion 12: Wishbone master has a single read port, the slave
+    // acknowledges only requests it accepted (in order), a stalled request
+    // stays on the bus unchanged, and the prefetch FIFOs never hold more than
+    // the MEM_LAT+1 reads in flight
+    initial if (PPC != 1) $error("[ASSERTION FAILED] NYANCAT_FRAME_MEM_WB requires PPC=1");
+    /* verilator lint_off WIDTHEXPAND */
     always @(posedge px_clk)
-        if (!reset && in_display) begin
-            if (frame_addr >= NUM_FRAMES * FRAME_SIZE)
-                $error(
-                    "[ASSERTION FAILED] frame_addr=%0d exceeds ROM size=%0d",
-                    frame_addr,
-                    NUM_FRAMES * FRAME_SIZE
-                );
+        if (!reset) begin
+            if (wb_ack_i && !wb_accept && wb_issued == wb_acked)
+                $error("[ASSERTION FAILED] wb_ack_i with no request outstanding");
+            if ($past(wb_hold) && !$past(reset) &&
+                (!wb_stb_o || wb_adr_o != $past(wb_adr_o)))
+                $error("[ASSERTION FAILED] Stalled Wishbone request changed before acceptance");
+            if (req_push && !req_pop && req_count == PF_DEPTH)
+                $error("[ASSERTION FAILED] Wishbone request FIFO overflow");
+            if (rsp_push && !rsp_pop && rsp_count == PF_DEPTH)
+                $error("[ASSERTION FAILED] Wishbone response FIFO overflow");
         end
+    /* verilator lint_on WIDTHEXPAND */
+`endif
 
-    // Assertion 7: ROM address timing alignment (check at actual cycle of use)
-    // frame_addr from previous cycle is what gets read into char_idx_q this cycle
-    always @(posedge px_clk)
-        if (past_valid && !reset && !$past(reset) && $past(in_display)) begin
-            if ($past(frame_addr) >= NUM_FRAMES * FRAME_SIZE)
-                $error(
-                    "[ASSERTION FAILED] ROM read with frame_addr=%0d exceeds size=%0d",
-                    $past(
-                        frame_addr
-                    ),
-                    NUM_FRAMES * FRAME_SIZE
-                );
+    // Assertion 13: Prefetch alignment - the flags coming due must describe
+    // the pixel under the beam, i.e. what a MEM_LAT=0 core computes for it
+    // now (window check and source column), and a display pixel must leave
+    // the pipeline while activevideo is high
+    initial begin
+        if (MEM_LAT < 0 || MEM_LAT > 16)
+            $error("[ASSERTION FAILED] MEM_LATENCY=%0d outside [0, 16]", MEM_LAT);
+        if (OFFSET_X < LANE_SKEW + FETCH_LEAD + LANE0_LEAD + PPC)
+            $error("[ASSERTION FAILED] MEM_LATENCY=%0d leads past the start of the line", MEM_LAT);
+    end
+
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_pf_check
+            /* verilator lint_off WIDTHEXPAND */
+            /* verilator lint_off WIDTHTRUNC */
+            wire [X_COORD_WIDTH:0] beam_x = x_px + LANE_SKEW + l;
+            wire beam_in_display = (beam_x >= offset_x) && (beam_x < offset_x + scaled_w) &&
+                in_display_y && coords_valid;
+            wire [X_COORD_WIDTH:0] beam_src_x = (beam_x - offset_x) / scale;
+            always @(posedge px_clk)
+                if (past_valid && !reset && !$past(reset)) begin
+                    if (in_display_due[l] !== beam_in_display)
+                        $error(
+                            "[ASSERTION FAILED] lane %0d prefetch in_display_due=%b, beam pixel x=%0d has %b",
+                            l,
+                            in_display_due[l],
+                            beam_x,
+                            beam_in_display
+                        );
+                    else if (beam_in_display && src_x_due[l] != beam_src_x)
+                        $error(
+                            "[ASSERTION FAILED] lane %0d prefetch src_x_due=%0d, beam pixel x=%0d needs %0d",
+                            l,
+                            src_x_due[l],
+                            beam_x,
+                            beam_src_x
+                        );
+                    if (in_display_q2[l] && !activevideo)
+                        $error("[ASSERTION FAILED] lane %0d display pixel outside activevideo", l);
+                end
+            /* verilator lint_on WIDTHTRUNC */
+            /* verilator lint_on WIDTHEXPAND */
         end
+    endgenerate
+
+`ifdef NYANCAT_FRAME_RLE
+`ifdef NYANCAT_FRAME_MEM_WB
+    initial $error("[ASSERTION FAILED] NYANCAT_FRAME_RLE requires the on-chip frame ROM");
+`else
+    // Assertion 14: Row decoder - two row decodes fit between the trigger
+    // and the next line's first frame read, a decode is never still running
+    // at the next trigger, and every row buffer read returns the character
+    // the uncompressed ROM holds
+    localparam DECODE_CLOCKS = 2 * (FRAME_W + 1) + 1;
+    localparam X_FIRST = OFFSET_X - LANE_SKEW - FETCH_LEAD - LANE0_LEAD;  // First read of a line
+    initial
+        if (DECODE_CLOCKS * PPC > H_TOTAL - X_DECODE + X_FIRST)
+            $error(
+                "[ASSERTION FAILED] Row decode (%0d clocks) does not fit in %0d blanking clocks",
+                DECODE_CLOCKS,
+                (H_TOTAL - X_DECODE + X_FIRST) / PPC
+            );
 
-    // Assertion 8: Output alignment - verify rrggbb matches pipeline correctly
-    // rrggbb is combinational: assign rrggbb = (activevideo && in_display_q2) ? color_q : 6'b0
-    // Check current cycle's activevideo and in_display_q2 against current rrggbb
     always @(posedge px_clk)
-        if (past_valid && !reset && !$past(reset)) begin
-            if (activevideo && in_display_q2) begin
-                if (rrggbb !== color_q)
+        if (!reset && dec_trigger && dec_busy)
+            $error("[ASSERTION FAILED] Row decode of row %0d still running at the next trigger", dec_row);
+
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_rle_check
+            always @(posedge px_clk)
+                if (!reset && frame_rom_en[l] && frame_rd[l] !== frame_mem[frame_addr[l]])
                     $error(
-                        "[ASSERTION FAILED] Output misalignment: rrggbb=%h should match color_q=%h",
-                        rrggbb,
-                        color_q
+                        "[ASSERTION FAILED] lane %0d row buffer char %0d != ROM %0d (frame %0d row %0d col %0d)",
+                        l,
+                        frame_rd[l],
+                        frame_mem[frame_addr[l]],
+                        lane_frame[l],
+                        src_y,
+                        lane_src_x[l]
                     );
-            end else begin
-                if (rrggbb !== 6'b0)
+        end
+    endgenerate
+`endif
+`endif
+
+`ifdef NYANCAT_FRAME_DELTA
+`ifdef NYANCAT_FRAME_MEM_WB
+    initial $error("[ASSERTION FAILED] NYANCAT_FRAME_DELTA requires the on-chip frame ROM");
+`else
+    // Assertion 15: Delta frames - the longest list fits in one blanking
+    // interval, no patch is still running when the picture starts, and every
+    // frame buffer read returns the character frame_mem holds for show_frame
+    initial
+        if (`NYANCAT_DELTA_MAX + 3 > VBLANK_CLOCKS)
+            $error(
+                "[ASSERTION FAILED] Delta list of %0d pixels does not fit in %0d blanking clocks",
+                `NYANCAT_DELTA_MAX,
+                VBLANK_CLOCKS
+            );
+
+    /* verilator lint_off WIDTHEXPAND */
+    always @(posedge px_clk)
+        if (!reset && activevideo && !coords_valid && y_px == 0 && dl_busy)
+            $error("[ASSERTION FAILED] Frame buffer patch from frame %0d still running at the first line",
+                   show_frame);
+    /* verilator lint_on WIDTHEXPAND */
+
+    generate
+        for (l = 0; l < PPC; l = l + 1) begin : lane_dl_check
+            always @(posedge px_clk)
+                if (!reset && frame_rom_en[l] && frame_rd[l] !== frame_mem[frame_addr[l]])
                     $error(
-                        "[ASSERTION FAILED] Output should be zero outside display, got rrggbb=%h",
-                        rrggbb
+                        "[ASSERTION FAILED] lane %0d frame_buf char %0d != ROM %0d (frame %0d row %0d col %0d)",
+                        l,
+                        frame_rd[l],
+                        frame_mem[frame_addr[l]],
+                        show_frame,
+                        src_y,
+                        lane_src_x[l]
                     );
-            end
         end
+    endgenerate
+`endif
+`endif
+
+`ifdef NYANCAT_FRAME_VSYNC
+`ifdef NYANCAT_FRAME_DELTA
+    initial $error("[ASSERTION FAILED] NYANCAT_FRAME_DELTA already changes frames in vertical blanking; drop NYANCAT_FRAME_VSYNC");
+`else
+    // Assertion 16: Tear-free sequencing - frame_index changes only at
+    // vblank_start, and a step that came due before vertical blanking is no
+    // longer pending when the picture starts (frame_counter counts from it)
+    always @(posedge px_clk)
+        if (past_valid && !reset && !$past(reset) && frame_index != $past(frame_index) &&
+            !$past(vblank_start))
+            $error("[ASSERTION FAILED] frame_index changed from %0d to %0d outside vertical blanking",
+                   $past(frame_index), frame_index);
 
-    // Assertion 9: Coordinate transformation validity (defense-in-depth)
-    // When in_display=1, verify that coordinate transformations are correct:
-    // - src_x and src_y must be within [0, FRAME_W-1] and [0, FRAME_H-1]
-    // - rel_x and rel_y must be within [0, SCALED_W-1] and [0, SCALED_H-1]
-    // This prevents wild pointer crashes in framebuffer updates
     /* verilator lint_off WIDTHEXPAND */
     always @(posedge px_clk)
-        if (past_valid && !reset && !$past(reset) && in_display) begin
-            if (src_x >= FRAME_W)
-                $error(
-                    "[ASSERTION FAILED] src_x=%0d exceeds FRAME_W=%0d (in_display=1)",
-                    src_x,
-                    FRAME_W
-                );
-            if (src_y >= FRAME_H)
-                $error(
-                    "[ASSERTION FAILED] src_y=%0d exceeds FRAME_H=%0d (in_display=1)",
-                    src_y,
-                    FRAME_H
-                );
-            if (rel_x >= SCALED_W)
-                $error(
-                    "[ASSERTION FAILED] rel_x=%0d exceeds SCALED_W=%0d (in_display=1)",
-                    rel_x,
-                    SCALED_W
-                );
-            if (rel_y >= SCALED_H)
-                $error(
-                    "[ASSERTION FAILED] rel_y=%0d exceeds SCALED_H=%0d (in_display=1)",
-                    rel_y,
-                    SCALED_H
-                );
+        if (!reset && activevideo && !coords_valid && y_px == 0 && step_pending && frame_counter > V_BLANK * H_TOTAL)
+            $error("[ASSERTION FAILED] Animation step pending across a whole blanking interval");
+    /* verilator lint_on WIDTHEXPAND */
+`endif
+`endif
+
+`ifdef VGA_TIMING_REGS
+    // Assertion 17: Programmable geometry - only the base pipeline follows
+    // scale/offset_x (the row decoder, delta patching and vblank sequencing
+    // size their schedules from the videomode.vh mode, and PPC=2 fixes the
+    // lane 0 lead), and a loaded geometry fits the sub-pixel counters and
+    // leaves room for the prefetch lead at the start of the line
+    initial begin
+        if (PPC != 1) $error("[ASSERTION FAILED] VGA_TIMING_REGS requires PPC=1");
+`ifdef NYANCAT_FRAME_ENCODED
+        $error("[ASSERTION FAILED] VGA_TIMING_REGS requires the raw frame ROM");
+`endif
+`ifdef NYANCAT_FRAME_VSYNC
+        $error("[ASSERTION FAILED] VGA_TIMING_REGS requires immediate frame advance");
+`endif
+    end
+
+    /* verilator lint_off WIDTHEXPAND */
+    always @(posedge px_clk)
+        if (past_valid && !reset && $past(timing_load)) begin
+            if (scale == 0 || scale > (1 << SUB_W))
+                $error("[ASSERTION FAILED] Loaded SCALE=%0d outside [1, %0d]", scale, 1 << SUB_W);
+            if (offset_x < LANE_SKEW + FETCH_LEAD + LANE0_LEAD + PPC)
+                $error("[ASSERTION FAILED] Loaded OFFSET_X=%0d leaves no room for MEM_LATENCY=%0d",
+                       offset_x, MEM_LAT);
         end
     /* verilator lint_on WIDTHEXPAND */
 `endif
+`endif
 
 endmodule
 `default_nettype wire
@@ -6,6 +6,9 @@
 // Include parameterized video mode definitions
 `include "videomode.vh"
 
+// Include memory interface definitions
+`include "memory_if.vh"
+
 // VGA Nyancat Display Top Module
 //
 // Top-level module that combines VGA timing generation with Nyancat animation
@@ -16,24 +19,68 @@
 //   clk → vga_sync_gen → {x_px, y_px, activevideo} → nyancat → rrggbb
 //                      ↘ {hsync, vsync}
 //
+// With PIXELS_PER_CLOCK=2 (see videomode.vh) clk runs at half the pixel
+// clock and rrggbb carries two adjacent pixels, left one in rrggbb[5:0].
+//
+// With NYANCAT_FRAME_MEM_WB the nyancat frame memory is external and its
+// Wishbone read port (wb_*) is brought out to the top level.
+//
+// With NYANCAT_FRAME_CRC a CRC-32 of each frame's pixels is latched at vsync
+// and brought out as frame_crc (see Frame CRC below), so the picture can be
+// checked on a board without capturing it.
+//
+// With VGA_TIMING_REGS the video timing and nyancat's SCALE/OFFSET_X are
+// registers written over the cfg_* bus (map in videomode.vh), so one build
+// can drive several monitors: write the values, write TIMING_REG_APPLY, and
+// the new mode starts with the next frame (cfg_busy drops on that clock).
+//
 // External interface uses active-low reset (reset_n) but internal modules
 // use active-high reset for consistency with typical HDL practice.
 module vga_nyancat (
-    input  wire       clk,          // Pixel clock (31.5 MHz)
-    input  wire       reset_n,      // Active-low reset
-    output wire       hsync,        // Horizontal sync to VGA display
-    output wire       vsync,        // Vertical sync to VGA display
-    output wire       activevideo,  // High when in visible display region
-    output wire [5:0] rrggbb        // 6-bit color output (2R2G2B)
+    input  wire                              clk,          // Pixel clock (31.5 MHz) / PPC
+    input  wire                              reset_n,      // Active-low reset
+    output wire                              hsync,        // Horizontal sync to VGA display
+    output wire                              vsync,        // Vertical sync to VGA display
+    output wire                              activevideo,  // High when in visible display region
+`ifdef VGA_TIMING_REGS
+    input  wire                              cfg_we,       // Timing register write
+    input  wire [                       3:0] cfg_addr,     // TIMING_REG_* (videomode.vh)
+    input  wire [                      15:0] cfg_wdata,    // Register value
+    output wire                              cfg_busy,     // Applied set not loaded yet
+`endif
+`ifdef NYANCAT_FRAME_MEM_WB
+    output wire                              wb_cyc_o,     // Frame memory Wishbone master
+    output wire                              wb_stb_o,
+    output wire                              wb_we_o,
+    output wire [ `FRAME_MEM_ADDR_WIDTH-1:0] wb_adr_o,
+    input  wire [ `FRAME_MEM_DATA_WIDTH-1:0] wb_dat_i,
+    input  wire                              wb_ack_i,
+    input  wire                              wb_stall_i,
+`endif
+`ifdef NYANCAT_FRAME_CRC
+    output reg  [                      31:0] frame_crc,        // CRC-32 of the last frame's active pixels
+    output reg                               frame_crc_valid,  // frame_crc updated this clock
+`endif
+    output wire [                 6*PPC-1:0] rrggbb        // 6-bit color output (2R2G2B) per pixel lane
 );
     // Internal signals connecting sync generator to animation renderer
     wire [X_COORD_WIDTH-1:0] x_px;  // Current pixel X coordinate from sync generator
     wire [Y_COORD_WIDTH-1:0] y_px;  // Current pixel Y coordinate from sync generator
+`ifdef VGA_TIMING_REGS
+    wire                     timing_load;  // New timing and geometry take effect
+`endif
 
     // VGA timing generator: produces sync signals and pixel coordinates
     vga_sync_gen vga_sync (
         .px_clk     (clk),
         .reset      (!reset_n),
+`ifdef VGA_TIMING_REGS
+        .cfg_we     (cfg_we),
+        .cfg_addr   (cfg_addr),
+        .cfg_wdata  (cfg_wdata),
+        .cfg_busy   (cfg_busy),
+        .timing_load(timing_load),
+`endif
         .hsync      (hsync),
         .vsync      (vsync),
         .x_px       (x_px),
@@ -48,7 +95,70 @@ module vga_nyancat (
         .x_px       (x_px),
         .y_px       (y_px),
         .activevideo(activevideo),
+`ifdef VGA_TIMING_REGS
+        .cfg_we     (cfg_we),
+        .cfg_addr   (cfg_addr),
+        .cfg_wdata  (cfg_wdata),
+        .timing_load(timing_load),
+`endif
+`ifdef NYANCAT_FRAME_MEM_WB
+        .wb_cyc_o   (wb_cyc_o),
+        .wb_stb_o   (wb_stb_o),
+        .wb_we_o    (wb_we_o),
+        .wb_adr_o   (wb_adr_o),
+        .wb_dat_i   (wb_dat_i),
+        .wb_ack_i   (wb_ack_i),
+        .wb_stall_i (wb_stall_i),
+`endif
         .rrggbb     (rrggbb)
     );
+
+`ifdef NYANCAT_FRAME_CRC
+    // =========================================================================
+    // Frame CRC (NYANCAT_FRAME_CRC)
+    // =========================================================================
+    // CRC-32 (IEEE 802.3, reflected, the value zlib's crc32() returns) of
+    // every pixel output while activevideo is high, one byte {2'b00, rrggbb}
+    // per pixel, lanes left to right. Blanking comes first in each frame, so
+    // the last active pixel precedes the vsync pulse: at its first clock the
+    // finished CRC is latched into frame_crc, frame_crc_valid pulses, and the
+    // accumulator restarts. The first latch after reset covers no pixels
+    // (frame_crc = 0).
+
+    localparam [31:0] CRC32_POLY = 32'hEDB88320;  // Reflected 0x04C11DB7
+
+    reg  [31:0] crc_acc;  // Running CRC (initial value all ones, not inverted)
+    reg  [31:0] crc_next;  // crc_acc with this clock's pixels folded in
+    reg         vsync_q;
+
+    integer crc_lane, crc_bit;
+    always @(*) begin
+        crc_next = crc_acc;
+        for (crc_lane = 0; crc_lane < PPC; crc_lane = crc_lane + 1) begin
+            crc_next = crc_next ^ {26'b0, rrggbb[6*crc_lane+:6]};
+            for (crc_bit = 0; crc_bit < 8; crc_bit = crc_bit + 1)
+                crc_next = (crc_next >> 1) ^ (crc_next[0] ? CRC32_POLY : 32'b0);
+        end
+    end
+
+    always @(posedge clk) begin
+        if (!reset_n) begin
+            crc_acc         <= 32'hFFFFFFFF;
+            vsync_q         <= 1;
+            frame_crc       <= 0;
+            frame_crc_valid <= 0;
+        end else begin
+            vsync_q         <= vsync;
+            frame_crc_valid <= 0;
+            if (!vsync && vsync_q) begin
+                frame_crc       <= ~crc_acc;
+                frame_crc_valid <= 1;
+                crc_acc         <= 32'hFFFFFFFF;
+            end else if (activevideo) begin
+                crc_acc <= crc_next;
+            end
+        end
+    end
+`endif
 endmodule
 `default_nettype wire
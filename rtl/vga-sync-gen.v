@@ -19,23 +19,59 @@
 //
 // Sync signals are active-low. Pixel coordinates (x_px, y_px) are valid
 // only when activevideo is high.
+//
+// With PPC (PIXELS_PER_CLOCK) = 2 each clock covers two pixels: hc advances
+// by 2 and x_px is the left (even) pixel of the pair.
+//
+// With VGA_TIMING_REGS the timing comes from registers written over the cfg
+// bus (see Timing Registers below) instead of the videomode.vh constants,
+// which become the reset values.
 module vga_sync_gen (
     input  wire                     px_clk,      // Pixel clock (mode-dependent)
     input  wire                     reset,       // Synchronous reset
+`ifdef VGA_TIMING_REGS
+    input  wire                     cfg_we,      // Timing register write
+    input  wire [              3:0] cfg_addr,    // TIMING_REG_* (videomode.vh)
+    input  wire [             15:0] cfg_wdata,   // Register value
+    output reg                      cfg_busy,    // TIMING_REG_APPLY waits for the frame end
+    output wire                     timing_load, // Shadow set becomes active this clock
+`endif
     output wire                     hsync,       // Horizontal sync (active low)
     output wire                     vsync,       // Vertical sync (active low)
-    output reg  [X_COORD_WIDTH-1:0] x_px,        // Pixel X coordinate [0, H_ACTIVE-1]
+    output reg  [X_COORD_WIDTH-1:0] x_px,        // Pixel X coordinate [0, H_ACTIVE-1] (lane 0)
     output reg  [Y_COORD_WIDTH-1:0] y_px,        // Pixel Y coordinate [0, V_ACTIVE-1]
     output wire                     activevideo  // High during visible display region
 );
     // Video mode parameters imported from videomode.vh:
     //   H_ACTIVE, H_FP, H_SYNC, H_BP, H_BLANK, H_TOTAL, H_COUNTER_WIDTH
     //   V_ACTIVE, V_FP, V_SYNC, V_BP, V_BLANK, V_TOTAL, V_COUNTER_WIDTH
-    //   X_COORD_WIDTH, Y_COORD_WIDTH
+    //   X_COORD_WIDTH, Y_COORD_WIDTH, PPC
+
+    localparam [H_COUNTER_WIDTH-1:0] HC_STEP = PPC;  // Pixels per clock
+
+    // Timing in use. Without VGA_TIMING_REGS these are the videomode.vh
+    // constants and synthesis folds them back into the comparisons; with it
+    // they are registers (Timing Registers below). One bit wider than the
+    // counters, so a total equal to 2^WIDTH still fits.
+`ifdef VGA_TIMING_REGS
+    reg  [H_COUNTER_WIDTH:0] h_active, h_fp, h_sync, h_bp;
+    reg  [V_COUNTER_WIDTH:0] v_active, v_fp, v_sync, v_bp;
+`else
+    wire [H_COUNTER_WIDTH:0] h_active = H_ACTIVE, h_fp = H_FP, h_sync = H_SYNC, h_bp = H_BP;
+    wire [V_COUNTER_WIDTH:0] v_active = V_ACTIVE, v_fp = V_FP, v_sync = V_SYNC, v_bp = V_BP;
+`endif
+    wire [H_COUNTER_WIDTH:0] h_blank = h_fp + h_sync + h_bp, h_total = h_blank + h_active;
+    wire [V_COUNTER_WIDTH:0] v_blank = v_fp + v_sync + v_bp, v_total = v_blank + v_active;
 
     // Scanning position counters (include blanking intervals)
-    reg [H_COUNTER_WIDTH-1:0] hc;  // Horizontal counter: [0, H_TOTAL-1]
-    reg [V_COUNTER_WIDTH-1:0] vc;  // Vertical counter: [0, V_TOTAL-1]
+    // public_flat_rd: read by the simulator's triggered trace capture
+    reg [H_COUNTER_WIDTH-1:0] hc  /* verilator public_flat_rd */;  // Horizontal counter: [0, H_TOTAL-1]
+    reg [V_COUNTER_WIDTH-1:0] vc  /* verilator public_flat_rd */;  // Vertical counter: [0, V_TOTAL-1]
+
+    /* verilator lint_off WIDTHEXPAND */
+    wire line_end = (hc >= h_total - PPC);  // Last clock of the line
+    wire frame_end = line_end && (vc >= v_total - 1);  // Last clock of the frame
+    /* verilator lint_on WIDTHEXPAND */
 
     // Raster scanning: left-to-right, top-to-bottom with wraparound
     always @(posedge px_clk) begin
@@ -45,28 +81,108 @@ module vga_sync_gen (
             x_px <= 0;
             y_px <= 0;
         end else begin
-            // Horizontal counter: increment each clock, wrap at end of line
-            if (hc < H_TOTAL - 1) begin
-                hc <= hc + 1;
+            // Horizontal counter: advance PPC pixels each clock, wrap at end of line
+            if (!line_end) begin
+                hc <= hc + HC_STEP;
             end else begin
                 hc <= 0;
                 // Vertical counter: increment at end of each line
-                vc <= (vc < V_TOTAL - 1) ? vc + 1 : 0;
+                vc <= frame_end ? 0 : vc + 1;
             end
             // Pixel coordinates: subtract blanking offset (valid when activevideo=1)
             /* verilator lint_off WIDTHTRUNC */
-            x_px <= hc - H_BLANK;  // Valid range: [0, H_ACTIVE-1]
-            y_px <= vc - V_BLANK;  // Valid range: [0, V_ACTIVE-1]
+            /* verilator lint_off WIDTHEXPAND */
+            x_px <= hc - h_blank;  // Valid range: [0, H_ACTIVE-1]
+            y_px <= vc - v_blank;  // Valid range: [0, V_ACTIVE-1]
+            /* verilator lint_on WIDTHEXPAND */
             /* verilator lint_on WIDTHTRUNC */
         end
     end
 
     // Sync pulse generation (active low during sync periods)
-    assign hsync = (hc >= H_FP && hc < H_FP + H_SYNC) ? 0 : 1;
-    assign vsync = (vc >= V_FP && vc < V_FP + V_SYNC) ? 0 : 1;
+    /* verilator lint_off WIDTHEXPAND */
+    assign hsync = (hc >= h_fp && hc < h_fp + h_sync) ? 0 : 1;
+    assign vsync = (vc >= v_fp && vc < v_fp + v_sync) ? 0 : 1;
 
     // Active video flag: high only when both counters are in visible region
-    assign activevideo = (hc >= H_BLANK && vc >= V_BLANK);
+    assign activevideo = (hc >= h_blank && vc >= v_blank);
+    /* verilator lint_on WIDTHEXPAND */
+
+`ifdef VGA_TIMING_REGS
+    // =========================================================================
+    // Timing Registers (VGA_TIMING_REGS)
+    // =========================================================================
+    // cfg writes land in a shadow set. TIMING_REG_APPLY raises cfg_busy; on
+    // the last clock of the frame the shadow set is loaded, timing_load lets
+    // nyancat load its SCALE/OFFSET_X shadows on the same edge, and cfg_busy
+    // drops. The next frame starts at hc = vc = 0 in the new mode, so a
+    // monitor never sees a line or frame that mixes two timings. Writes while
+    // cfg_busy is high still update the shadow set for that load.
+    //
+    // Sync widths and porches must be non-zero, totals must fit the counters
+    // (H_TOTAL_MAX/V_TOTAL_MAX modes at least), and with PPC=2 every
+    // horizontal value must be even; Assertion 9 checks a loaded set.
+
+    reg [H_COUNTER_WIDTH:0] h_active_cfg, h_fp_cfg, h_sync_cfg, h_bp_cfg;
+    reg [V_COUNTER_WIDTH:0] v_active_cfg, v_fp_cfg, v_sync_cfg, v_bp_cfg;
+
+    assign timing_load = frame_end && cfg_busy;
+
+    /* verilator lint_off WIDTHTRUNC */
+    always @(posedge px_clk) begin
+        if (reset) begin
+            h_active_cfg <= H_ACTIVE;
+            h_fp_cfg     <= H_FP;
+            h_sync_cfg   <= H_SYNC;
+            h_bp_cfg     <= H_BP;
+            v_active_cfg <= V_ACTIVE;
+            v_fp_cfg     <= V_FP;
+            v_sync_cfg   <= V_SYNC;
+            v_bp_cfg     <= V_BP;
+            cfg_busy     <= 0;
+        end else begin
+            if (cfg_we) begin
+                case (cfg_addr)
+                    `TIMING_REG_H_ACTIVE: h_active_cfg <= cfg_wdata;
+                    `TIMING_REG_H_FP:     h_fp_cfg     <= cfg_wdata;
+                    `TIMING_REG_H_SYNC:   h_sync_cfg   <= cfg_wdata;
+                    `TIMING_REG_H_BP:     h_bp_cfg     <= cfg_wdata;
+                    `TIMING_REG_V_ACTIVE: v_active_cfg <= cfg_wdata;
+                    `TIMING_REG_V_FP:     v_fp_cfg     <= cfg_wdata;
+                    `TIMING_REG_V_SYNC:   v_sync_cfg   <= cfg_wdata;
+                    `TIMING_REG_V_BP:     v_bp_cfg     <= cfg_wdata;
+                    default: ;
+                endcase
+            end
+            if (cfg_we && cfg_addr == `TIMING_REG_APPLY) cfg_busy <= 1;
+            else if (timing_load) cfg_busy <= 0;
+        end
+    end
+
+    // Active set: the reset mode, then the shadow set at each timing_load
+    always @(posedge px_clk) begin
+        if (reset) begin
+            h_active <= H_ACTIVE;
+            h_fp     <= H_FP;
+            h_sync   <= H_SYNC;
+            h_bp     <= H_BP;
+            v_active <= V_ACTIVE;
+            v_fp     <= V_FP;
+            v_sync   <= V_SYNC;
+            v_bp     <= V_BP;
+        end else if (timing_load) begin
+            h_active <= h_active_cfg;
+            h_fp     <= h_fp_cfg;
+            h_sync   <= h_sync_cfg;
+            h_bp     <= h_bp_cfg;
+            v_active <= v_active_cfg;
+            v_fp     <= v_fp_cfg;
+            v_sync   <= v_sync_cfg;
+            v_bp     <= v_bp_cfg;
+        end
+    end
+    /* verilator lint_on WIDTHTRUNC */
+`endif
 
     // =========================================================================
     // Verification Assertions (Verilator simulation only)
@@ -79,23 +195,31 @@ module vga_sync_gen (
     reg past_valid = 0;
     always @(posedge px_clk) past_valid <= 1;
 
+    // The checks below follow the timing in use (h_total etc.), which with
+    // VGA_TIMING_REGS can change at a frame boundary: the wrap checks
+    // compare against the totals of the clock that wrapped.
+
     // Assertion 1: Horizontal counter wraparound at H_TOTAL boundary
+    /* verilator lint_off WIDTHEXPAND */
     always @(posedge px_clk)
         if (past_valid && !reset && !$past(reset)) begin
-            if ($past(hc) == H_TOTAL - 1 && hc != 0)
-                $error("[ASSERTION FAILED] hc should wrap to 0 after H_TOTAL-1, got %0d", hc);
-            if ($past(hc) < H_TOTAL - 1 && hc != $past(hc) + 1)
+            if ($past(hc) == $past(h_total) - PPC && hc != 0)
+                $error("[ASSERTION FAILED] hc should wrap to 0 after H_TOTAL-PPC, got %0d", hc);
+            if ($past(hc) < $past(h_total) - PPC && hc != $past(hc) + HC_STEP)
                 $error(
-                    "[ASSERTION FAILED] hc should increment by 1, was %0d now %0d", $past(hc), hc
+                    "[ASSERTION FAILED] hc should increment by %0d, was %0d now %0d",
+                    PPC,
+                    $past(hc),
+                    hc
                 );
         end
 
     // Assertion 2: Vertical counter wraparound at V_TOTAL boundary
     always @(posedge px_clk)
-        if (past_valid && !reset && !$past(reset) && $past(hc) == H_TOTAL - 1) begin
-            if ($past(vc) == V_TOTAL - 1 && vc != 0)
+        if (past_valid && !reset && !$past(reset) && $past(hc) == $past(h_total) - PPC) begin
+            if ($past(vc) == $past(v_total) - 1 && vc != 0)
                 $error("[ASSERTION FAILED] vc should wrap to 0 after V_TOTAL-1, got %0d", vc);
-            if ($past(vc) < V_TOTAL - 1 && vc != $past(vc) + 1)
+            if ($past(vc) < $past(v_total) - 1 && vc != $past(vc) + 1)
                 $error(
                     "[ASSERTION FAILED] vc should increment by 1, was %0d now %0d", $past(vc), vc
                 );
@@ -104,15 +228,15 @@ module vga_sync_gen (
     // Assertion 3: Counter bounds - should never exceed total values
     always @(posedge px_clk)
         if (!reset) begin
-            if (hc >= H_TOTAL) $error("[ASSERTION FAILED] hc=%0d exceeds H_TOTAL=%0d", hc, H_TOTAL);
-            if (vc >= V_TOTAL) $error("[ASSERTION FAILED] vc=%0d exceeds V_TOTAL=%0d", vc, V_TOTAL);
+            if (hc >= h_total) $error("[ASSERTION FAILED] hc=%0d exceeds H_TOTAL=%0d", hc, h_total);
+            if (vc >= v_total) $error("[ASSERTION FAILED] vc=%0d exceeds V_TOTAL=%0d", vc, v_total);
         end
 
     // Assertion 4: Hsync timing correctness
     // hsync should be low only during [H_FP, H_FP+H_SYNC) range
     always @(posedge px_clk)
         if (!reset) begin
-            if (hc >= H_FP && hc < H_FP + H_SYNC) begin
+            if (hc >= h_fp && hc < h_fp + h_sync) begin
                 if (hsync !== 0) $error("[ASSERTION FAILED] hsync should be low at hc=%0d", hc);
             end else begin
                 if (hsync !== 1) $error("[ASSERTION FAILED] hsync should be high at hc=%0d", hc);
@@ -123,7 +247,7 @@ module vga_sync_gen (
     // vsync should be low only during [V_FP, V_FP+V_SYNC) range
     always @(posedge px_clk)
         if (!reset) begin
-            if (vc >= V_FP && vc < V_FP + V_SYNC) begin
+            if (vc >= v_fp && vc < v_fp + v_sync) begin
                 if (vsync !== 0) $error("[ASSERTION FAILED] vsync should be low at vc=%0d", vc);
             end else begin
                 if (vsync !== 1) $error("[ASSERTION FAILED] vsync should be high at vc=%0d", vc);
@@ -134,7 +258,7 @@ module vga_sync_gen (
     // activevideo should be high only when both hc >= H_BLANK and vc >= V_BLANK
     always @(posedge px_clk)
         if (!reset) begin
-            if (hc >= H_BLANK && vc >= V_BLANK) begin
+            if (hc >= h_blank && vc >= v_blank) begin
                 if (!activevideo)
                     $error(
                         "[ASSERTION FAILED] activevideo should be high at hc=%0d vc=%0d", hc, vc
@@ -144,6 +268,7 @@ module vga_sync_gen (
                     $error("[ASSERTION FAILED] activevideo should be low at hc=%0d vc=%0d", hc, vc);
             end
         end
+    /* verilator lint_on WIDTHEXPAND */
 
     // Assertion 7: Pixel coordinates validity during active video
     // Note: x_px and y_px are registered (1-cycle delayed from hc/vc)
@@ -151,17 +276,17 @@ module vga_sync_gen (
     /* verilator lint_off WIDTHEXPAND */
     always @(posedge px_clk)
         if (past_valid && !reset && !$past(reset) && $past(activevideo)) begin
-            if (x_px >= H_ACTIVE)
+            if (x_px >= $past(h_active))
                 $error(
                     "[ASSERTION FAILED] x_px=%0d exceeds H_ACTIVE=%0d (prev activevideo)",
                     x_px,
-                    H_ACTIVE
+                    $past(h_active)
                 );
-            if (y_px >= V_ACTIVE)
+            if (y_px >= $past(v_active))
                 $error(
                     "[ASSERTION FAILED] y_px=%0d exceeds V_ACTIVE=%0d (prev activevideo)",
                     y_px,
-                    V_ACTIVE
+                    $past(v_active)
                 );
         end
     /* verilator lint_on WIDTHEXPAND */
@@ -172,13 +297,19 @@ module vga_sync_gen (
     // Note: Must truncate to actual signal width to match RTL behavior (handles underflow)
     reg [H_COUNTER_WIDTH-1:0] hc_prev;
     reg [V_COUNTER_WIDTH-1:0] vc_prev;
+    reg [H_COUNTER_WIDTH:0] h_blank_prev;
+    reg [V_COUNTER_WIDTH:0] v_blank_prev;
     always @(posedge px_clk) begin
         hc_prev <= hc;
         vc_prev <= vc;
+        h_blank_prev <= h_blank;
+        v_blank_prev <= v_blank;
     end
     /* verilator lint_off WIDTHTRUNC */
-    wire [X_COORD_WIDTH-1:0] expected_x_px = hc_prev - H_BLANK;
-    wire [Y_COORD_WIDTH-1:0] expected_y_px = vc_prev - V_BLANK;
+    /* verilator lint_off WIDTHEXPAND */
+    wire [X_COORD_WIDTH-1:0] expected_x_px = hc_prev - h_blank_prev;
+    wire [Y_COORD_WIDTH-1:0] expected_y_px = vc_prev - v_blank_prev;
+    /* verilator lint_on WIDTHEXPAND */
     /* verilator lint_on WIDTHTRUNC */
 
     always @(posedge px_clk)
@@ -198,6 +329,28 @@ module vga_sync_gen (
                     vc_prev
                 );
         end
+
+`ifdef VGA_TIMING_REGS
+    // Assertion 9: A loaded timing set is one the counters can scan - syncs,
+    // porches and active areas non-zero, totals within the counter widths,
+    // active areas within the coordinate widths, hc steps landing on h_total
+    /* verilator lint_off WIDTHEXPAND */
+    always @(posedge px_clk)
+        if (past_valid && !reset && $past(timing_load)) begin
+            if (h_fp == 0 || h_sync == 0 || h_bp == 0 || h_active == 0 ||
+                v_fp == 0 || v_sync == 0 || v_bp == 0 || v_active == 0)
+                $error("[ASSERTION FAILED] Loaded timing has a zero porch, sync or active value");
+            if (h_total > (1 << H_COUNTER_WIDTH) || v_total > (1 << V_COUNTER_WIDTH))
+                $error("[ASSERTION FAILED] Loaded totals %0dx%0d exceed the counters (%0d/%0d bits)",
+                       h_total, v_total, H_COUNTER_WIDTH, V_COUNTER_WIDTH);
+            if (h_active > (1 << X_COORD_WIDTH) || v_active > (1 << Y_COORD_WIDTH))
+                $error("[ASSERTION FAILED] Loaded active area %0dx%0d exceeds the coordinates",
+                       h_active, v_active);
+            if (h_total % PPC != 0 || h_fp % PPC != 0 || h_sync % PPC != 0 || h_bp % PPC != 0)
+                $error("[ASSERTION FAILED] Loaded horizontal timing is not a multiple of PPC=%0d", PPC);
+        end
+    /* verilator lint_on WIDTHEXPAND */
+`endif
 `endif
 
 endmodule
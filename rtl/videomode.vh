@@ -140,6 +140,20 @@
   localparam V_BP     = 29;
 `endif
 
+// ============================================================================
+// Pixels per Clock
+// ============================================================================
+// Define PIXELS_PER_CLOCK=2 to run the core at half the pixel clock: hc
+// steps by two and nyancat produces two horizontally adjacent pixels per
+// clock (lane 0 = left pixel in rrggbb[5:0], lane 1 in rrggbb[11:6]). Every
+// horizontal timing value above is even, so syncs stay on clock boundaries.
+
+`ifndef PIXELS_PER_CLOCK
+  `define PIXELS_PER_CLOCK 1
+`endif
+
+localparam PPC = `PIXELS_PER_CLOCK;
+
 // ============================================================================
 // Computed Parameters (automatically derived from above)
 // ============================================================================
@@ -149,10 +163,43 @@ localparam V_BLANK = V_FP + V_SYNC + V_BP;
 localparam H_TOTAL = H_ACTIVE + H_BLANK;
 localparam V_TOTAL = V_ACTIVE + V_BLANK;
 
+// ============================================================================
+// Programmable Timing (VGA_TIMING_REGS)
+// ============================================================================
+// Define VGA_TIMING_REGS to load the timing at runtime: the mode selected
+// above becomes the reset value, and a write-only register bus on
+// vga_nyancat (cfg_we, cfg_addr, cfg_wdata) sets the values below. Writes go
+// to a shadow set; writing TIMING_REG_APPLY makes it the active timing at the
+// end of the current frame (cfg_busy is high until then), so every frame is
+// drawn entirely in one mode. Counters and coordinates are then sized for
+// the largest supported mode (XGA 1024x768) rather than the reset mode.
+
+`define TIMING_REG_H_ACTIVE 4'd0
+`define TIMING_REG_H_FP     4'd1
+`define TIMING_REG_H_SYNC   4'd2
+`define TIMING_REG_H_BP     4'd3
+`define TIMING_REG_V_ACTIVE 4'd4
+`define TIMING_REG_V_FP     4'd5
+`define TIMING_REG_V_SYNC   4'd6
+`define TIMING_REG_V_BP     4'd7
+`define TIMING_REG_SCALE    4'd8   // nyancat.v: source pixel size in pixels
+`define TIMING_REG_OFFSET_X 4'd9   // nyancat.v: left edge of the picture
+`define TIMING_REG_APPLY    4'd15  // Any value: load the shadow set at frame end
+
+localparam H_ACTIVE_MAX = 1024, V_ACTIVE_MAX = 768;
+localparam H_TOTAL_MAX = 1344, V_TOTAL_MAX = 806;
+
 // Bit widths for counters (computed at elaboration time)
+`ifdef VGA_TIMING_REGS
+localparam H_COUNTER_WIDTH = $clog2(H_TOTAL_MAX);
+localparam V_COUNTER_WIDTH = $clog2(V_TOTAL_MAX);
+localparam X_COORD_WIDTH = $clog2(H_ACTIVE_MAX);
+localparam Y_COORD_WIDTH = $clog2(V_ACTIVE_MAX);
+`else
 localparam H_COUNTER_WIDTH = $clog2(H_TOTAL);
 localparam V_COUNTER_WIDTH = $clog2(V_TOTAL);
 localparam X_COORD_WIDTH = $clog2(H_ACTIVE);
 localparam Y_COORD_WIDTH = $clog2(V_ACTIVE);
+`endif
 
 `endif // VIDEOMODE_VH
@@ -5,16 +5,51 @@ Analyzes VCD trace files to verify VGA timing and signal integrity.
 Detects timing violations, signal glitches, and validates sync signals.
 
 Usage:
-    python3 analyze-vcd.py waves.vcd [--report report.txt]
+    python3 analyze-vcd.py waves.vcd [--report report.txt] [--stream] [--jobs N]
+
+--stream analyzes the trace in a single pass with constant memory instead
+of loading every value change; the report and exit code are identical.
+--jobs N splits the value changes at #timestamp lines and streams the
+chunks in N worker processes, then merges their edge state in order.
 
 Requirements:
     None - uses built-in Python libraries only
 """
 
+import os
 import sys
+import time
 import argparse
+import multiprocessing
 from collections import defaultdict
 
+try:
+    import resource
+except ImportError:  # Not available on Windows
+    resource = None
+
+
+def report_throughput(filename, seconds):
+    """Print parse throughput (MB/s) and peak resident memory
+
+    The peak is that of the largest process, including --jobs workers.
+    """
+    try:
+        size_mb = os.path.getsize(filename) / (1024 * 1024)
+    except OSError:
+        return
+    rate = size_mb / seconds if seconds > 0 else 0
+    line = f"Parsed {size_mb:.1f} MB in {seconds:.2f} s ({rate:.1f} MB/s)"
+    if resource:
+        peak_kb = max(
+            resource.getrusage(resource.RUSAGE_SELF).ru_maxrss,
+            resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss,
+        )
+        if sys.platform == "darwin":
+            peak_kb //= 1024  # ru_maxrss is in bytes on macOS
+        line += f", peak memory {peak_kb / 1024:.1f} MB"
+    print(line)
+
 
 class VCDParser:
     """Minimal VCD parser - no external dependencies"""
@@ -105,12 +140,14 @@ class VGATimingAnalyzer:
         """Parse VCD file and extract signal data"""
         print(f"Parsing VCD file: {self.vcd_file}")
 
+        start = time.perf_counter()
         try:
             self.vcd = VCDParser(self.vcd_file)
             self.vcd.parse()
         except Exception as e:
             print(f"Error parsing VCD: {e}")
             return False
+        report_throughput(self.vcd_file, time.perf_counter() - start)
 
         print(f"Timescale: {self.vcd.timescale}")
         print(f"End time: {self.vcd.endtime}")
@@ -285,6 +322,16 @@ class VGATimingAnalyzer:
 
         return edges
 
+    def average_period(self, key):
+        """Mean hsync/vsync period, or None without a full period"""
+        periods = self.analysis_results[f"{key}_period"]
+        if not periods:
+            return None
+        return sum(periods) / len(periods)
+
+    def glitch_count(self):
+        return len(self.analysis_results["glitches"])
+
     def list_signals(self):
         """List all available signals in VCD"""
         print("\nAvailable signals:")
@@ -306,16 +353,12 @@ class VGATimingAnalyzer:
         report.append(f"Hsync pulses: {self.analysis_results['hsync_count']}")
         report.append(f"Vsync pulses: {self.analysis_results['vsync_count']}")
 
-        if self.analysis_results["hsync_period"]:
-            avg = sum(self.analysis_results["hsync_period"]) / len(
-                self.analysis_results["hsync_period"]
-            )
+        avg = self.average_period("hsync")
+        if avg is not None:
             report.append(f"Avg hsync period: {avg:.2f} time units")
 
-        if self.analysis_results["vsync_period"]:
-            avg = sum(self.analysis_results["vsync_period"]) / len(
-                self.analysis_results["vsync_period"]
-            )
+        avg = self.average_period("vsync")
+        if avg is not None:
             report.append(f"Avg vsync period: {avg:.2f} time units")
 
         report.append(
@@ -323,7 +366,7 @@ class VGATimingAnalyzer:
         )
 
         report.append(f"\n--- Issues Detected ---")
-        report.append(f"Glitches: {len(self.analysis_results['glitches'])}")
+        report.append(f"Glitches: {self.glitch_count()}")
         report.append(
             f"Timing violations: {len(self.analysis_results['timing_violations'])}"
         )
@@ -345,6 +388,392 @@ class VGATimingAnalyzer:
         return report_text
 
 
+class StreamingSignal:
+    """Running state of one signal name (all VCD ids sharing the name)
+
+    Mirrors what VGATimingAnalyzer derives from a full (time, value) list:
+    falling edges and their periods, closed high intervals, short pulses.
+    Only sums, extremes and the first few glitches are kept. The first
+    entry and first falling edge are kept as well, so the state of a later
+    chunk of the same trace can be appended with merge().
+    """
+
+    MAX_GLITCHES_KEPT = 5
+
+    def __init__(self, order):
+        self.order = order  # Position of first value change (dict order)
+        self.entries = 0
+        self.first_time = None
+        self.first_value = None
+        self.prev_time = None
+        self.prev_value = None
+        self.falling_edges = 0
+        self.first_fall = None
+        self.last_fall = None
+        self.period_count = 0
+        self.period_sum = 0
+        self.period_min = None
+        self.period_max = None
+        self.high_time = 0
+        self.glitch_count = 0
+        self.glitches = []
+
+    def _add_period(self, period):
+        self.period_count += 1
+        self.period_sum += period
+        self._add_period_extremes(period, period)
+
+    def _add_period_extremes(self, low, high):
+        if self.period_min is None or low < self.period_min:
+            self.period_min = low
+        if self.period_max is None or high > self.period_max:
+            self.period_max = high
+
+    def add(self, t, value, glitch_threshold):
+        prev_time, prev_value = self.prev_time, self.prev_value
+        if self.entries:
+            if prev_value == "1" and value == "0":
+                if self.last_fall is not None:
+                    self._add_period(t - self.last_fall)
+                else:
+                    self.first_fall = t
+                self.last_fall = t
+                self.falling_edges += 1
+            if prev_value == "1":
+                self.high_time += t - prev_time
+            if t - prev_time < glitch_threshold and prev_value != value:
+                self.glitch_count += 1
+                if len(self.glitches) < self.MAX_GLITCHES_KEPT:
+                    self.glitches.append((prev_time, t - prev_time))
+        else:
+            self.first_time, self.first_value = t, value
+        self.entries += 1
+        self.prev_time, self.prev_value = t, value
+
+    def merge(self, later, glitch_threshold):
+        """Append the state of the same signal from the following chunk"""
+        if not later.entries:
+            return
+        # The transition across the chunk boundary is seen by neither chunk
+        self.add(later.first_time, later.first_value, glitch_threshold)
+        if later.first_fall is not None:
+            if self.last_fall is not None:
+                self._add_period(later.first_fall - self.last_fall)
+            else:
+                self.first_fall = later.first_fall
+            self.last_fall = later.last_fall
+        self.falling_edges += later.falling_edges
+        if later.period_count:
+            self.period_count += later.period_count
+            self.period_sum += later.period_sum
+            self._add_period_extremes(later.period_min, later.period_max)
+        self.high_time += later.high_time
+        self.glitch_count += later.glitch_count
+        room = self.MAX_GLITCHES_KEPT - len(self.glitches)
+        self.glitches += later.glitches[:room]
+        self.entries += later.entries - 1  # First entry was added above
+        self.prev_time, self.prev_value = later.prev_time, later.prev_value
+
+    def period_stats(self):
+        """(count, average, max deviation) as computed from the full list"""
+        if not self.period_count:
+            return 0, 0, 0
+        avg = self.period_sum / self.period_count
+        max_dev = max(abs(self.period_max - avg), abs(self.period_min - avg))
+        return self.period_count, avg, max_dev
+
+
+class StreamingVCDSummary:
+    """Stand-in for VCDParser with only what the report needs"""
+
+    def __init__(self):
+        self.timescale = "1 ns"
+        self.endtime = 0
+        self.signal_data = {}  # Names that changed (values are not kept)
+
+
+def read_vcd_header(f):
+    """Parse the header of a VCD opened in binary mode
+
+    Same rules as VCDParser.parse. Returns (timescale, id_code -> name)
+    and leaves f positioned at the first value change line.
+    """
+    timescale = "1 ns"
+    names = {}
+    for raw in iter(f.readline, b""):
+        line = raw.decode("utf-8", "replace").strip()
+        if not line:
+            continue
+        if line.startswith("$timescale"):
+            timescale = line.split()[1]
+        elif line.startswith("$var"):
+            parts = line.split()
+            if len(parts) >= 5:
+                names[parts[3]] = parts[4]
+        elif line.startswith("$enddefinitions"):
+            break
+    return timescale, names
+
+
+def find_chunk_bounds(f, body_start, size, jobs):
+    """Split [body_start, size) into byte ranges starting at #timestamp lines
+
+    Every chunk but the first begins with a timestamp, so a worker knows
+    the current time from its first line and never needs its predecessor.
+    """
+    bounds = [body_start]
+    for k in range(1, jobs):
+        target = body_start + (size - body_start) * k // jobs
+        if target <= bounds[-1]:
+            continue
+        f.seek(target)
+        f.readline()  # Skip the partial line
+        pos = f.tell()
+        for raw in iter(f.readline, b""):
+            if raw.startswith(b"#"):
+                break
+            pos += len(raw)
+        else:
+            break  # No timestamp after target: the rest stays in this chunk
+        if pos > bounds[-1]:
+            bounds.append(pos)
+    bounds.append(size)
+    return list(zip(bounds[:-1], bounds[1:]))
+
+
+def scan_vcd_chunk(filename, start, end, names, candidates, threshold):
+    """Stream the value changes in bytes [start, end) of a VCD file
+
+    Returns (endtime, names in first-change order, name -> StreamingSignal
+    for the candidate names). Runs in a worker process for --jobs.
+    """
+    endtime = 0
+    changed = {}
+    streams = {}
+    tracked = {}  # id_code -> StreamingSignal (key signal candidates)
+
+    # latin-1 maps each byte to one character, so lengths are byte counts
+    with open(filename, "r", encoding="latin-1", newline="") as f:
+        f.seek(start)
+        remaining = end - start
+        current_time = 0
+        for line in f:
+            if remaining <= 0:
+                break
+            remaining -= len(line)
+            line = line.strip()
+            if not line:
+                continue
+            c = line[0]
+            if c == "#":
+                current_time = int(line[1:])
+                if current_time > endtime:
+                    endtime = current_time
+                continue
+            if c == "b":
+                parts = line.split()
+                if len(parts) < 2:
+                    continue
+                value, id_code = parts[0][1:], parts[1]
+            elif len(line) >= 2 and c in "01xzXZ":
+                value, id_code = c, line[1:]
+            else:
+                continue
+
+            stream = tracked.get(id_code)
+            if stream is None:
+                name = names.get(id_code)
+                if name is None:
+                    continue
+                if name not in changed:
+                    changed[name] = None
+                if name not in candidates:
+                    continue
+                stream = streams.get(name)
+                if stream is None:
+                    stream = StreamingSignal(len(changed) - 1)
+                    streams[name] = stream
+                tracked[id_code] = stream
+            stream.add(current_time, value, threshold)
+
+    return endtime, list(changed), streams
+
+
+def _scan_vcd_chunk_args(args):
+    return scan_vcd_chunk(*args)
+
+
+class StreamingVGATimingAnalyzer(VGATimingAnalyzer):
+    """Single-pass, constant-memory version of VGATimingAnalyzer
+
+    Reads the VCD once and keeps running state only for signal names that
+    the analysis can select (partial matches of hsync, vsync, activevideo).
+    get_signal() picks the first matching name in value-change order, as
+    the list-based parser does, so every candidate is tracked until the
+    end. rrggbb is not needed by the report and is not tracked. Memory is
+    bounded by the number of declared signals, not by trace length.
+
+    With jobs > 1 the value change section is split into time-aligned
+    chunks that are scanned by worker processes; the per-chunk states are
+    then merged in file order, which yields the same result.
+    """
+
+    KEY_SIGNALS = ["hsync", "vsync", "activevideo"]
+    GLITCH_THRESHOLD = 10  # Time units (same as detect_glitches)
+
+    def __init__(self, vcd_file, jobs=1):
+        super().__init__(vcd_file)
+        self.jobs = max(1, jobs)
+        self.streams = {}  # signal name -> StreamingSignal
+        self.total_glitches = 0
+
+    def parse_vcd(self):
+        """Stream the VCD file once, updating running signal state"""
+        mode = "streaming" if self.jobs == 1 else f"{self.jobs} jobs"
+        print(f"Parsing VCD file: {self.vcd_file} ({mode})")
+        start = time.perf_counter()
+        try:
+            self._stream()
+        except Exception as e:
+            print(f"Error parsing VCD: {e}")
+            return False
+        report_throughput(self.vcd_file, time.perf_counter() - start)
+
+        print(f"Timescale: {self.vcd.timescale}")
+        print(f"End time: {self.vcd.endtime}")
+        print(f"Found {len(self.vcd.signal_data)} signals")
+        return True
+
+    def _stream(self):
+        self.vcd = StreamingVCDSummary()
+        threshold = self.GLITCH_THRESHOLD
+
+        with open(self.vcd_file, "rb") as f:
+            self.vcd.timescale, names = read_vcd_header(f)
+            body_start = f.tell()
+            size = os.fstat(f.fileno()).st_size
+            chunks = find_chunk_bounds(f, body_start, size, self.jobs)
+
+        candidates = {
+            name
+            for name in set(names.values())
+            if any(key in name for key in self.KEY_SIGNALS)
+        }
+        work = [
+            (self.vcd_file, lo, hi, names, candidates, threshold)
+            for lo, hi in chunks
+        ]
+        if len(work) > 1:
+            with multiprocessing.Pool(min(self.jobs, len(work))) as pool:
+                results = pool.map(_scan_vcd_chunk_args, work)
+        else:
+            results = [_scan_vcd_chunk_args(args) for args in work]
+
+        changed = self.vcd.signal_data
+        for endtime, chunk_changed, chunk_streams in results:
+            self.vcd.endtime = max(self.vcd.endtime, endtime)
+            for name in chunk_changed:
+                if name not in changed:
+                    changed[name] = None
+            for name, stream in chunk_streams.items():
+                if name in self.streams:
+                    self.streams[name].merge(stream, threshold)
+                else:
+                    self.streams[name] = stream
+        # Value-change order over the whole file, as in VCDParser
+        order = {name: i for i, name in enumerate(changed)}
+        for name, stream in self.streams.items():
+            stream.order = order[name]
+
+    def get_stream(self, signal_name):
+        """First matching name in value-change order (like get_signal)"""
+        matches = [s for n, s in self.streams.items() if signal_name in n]
+        return min(matches, key=lambda s: s.order) if matches else None
+
+    def analyze_sync_signals(self):
+        """Analyze hsync and vsync timing"""
+        print("\n=== Analyzing Sync Signals ===")
+        for label, key in (("Hsync", "hsync"), ("Vsync", "vsync")):
+            stream = self.get_stream(key)
+            if not stream:
+                print(f"  Warning: {key} signal not found")
+                continue
+            self.analysis_results[f"{key}_count"] = stream.falling_edges
+            if stream.period_count:
+                avg = stream.period_sum / stream.period_count
+                print(f"  {label} pulses: {stream.falling_edges}")
+                print(f"  Avg {key} period: {avg:.0f} time units")
+
+    def analyze_activevideo(self):
+        """Analyze activevideo signal"""
+        print("\n=== Analyzing Active Video ===")
+        stream = self.get_stream("activevideo")
+        if not stream:
+            print("  Warning: activevideo signal not found")
+            return
+        self.analysis_results["activevideo_cycles"] = stream.high_time
+        print(f"  Active video cycles: {stream.high_time}")
+
+    def detect_glitches(self):
+        """Detect signal glitches (very short pulses)"""
+        print("\n=== Detecting Glitches ===")
+        shown = []
+        total = 0
+        for key in self.KEY_SIGNALS:
+            stream = self.get_stream(key)
+            if not stream or stream.entries < 2:
+                continue
+            total += stream.glitch_count
+            shown += [(key, t, d) for t, d in stream.glitches]
+
+        # Only the count and the first five are reported
+        self.total_glitches = total
+        self.analysis_results["glitches"] = shown[:5]
+        if total:
+            print(f"  Found {total} potential glitches")
+            for key, t, d in shown[:5]:
+                print(f"    {key} @ {t}: {d} units")
+        else:
+            print("  No glitches detected")
+
+    def validate_vga_timing(self):
+        """Validate VGA timing consistency (works for any video mode)"""
+        print("\n=== VGA Timing Validation ===")
+        max_variance = 0.01  # 1% maximum variance between periods
+
+        for label, key in (("Hsync", "hsync"), ("Vsync", "vsync")):
+            stream = self.get_stream(key)
+            if not stream:
+                continue
+            count, avg, max_dev = stream.period_stats()
+            if count <= 1:
+                continue
+            variance = max_dev / avg if avg > 0 else 0
+            if variance > max_variance:
+                violation = f"{label} period inconsistent: {variance*100:.1f}% variance (max {max_variance*100:.1f}%)"
+                self.analysis_results["timing_violations"].append(violation)
+                print(f"  ✗ {violation}")
+            else:
+                print(
+                    f"  ✓ {label} period consistent: {avg:.0f} time units (variance {variance*100:.2f}%)"
+                )
+
+    def average_period(self, key):
+        stream = self.get_stream(key)
+        if not stream or not stream.period_count:
+            return None
+        return stream.period_sum / stream.period_count
+
+    def glitch_count(self):
+        return self.total_glitches
+
+    def list_signals(self):
+        """List all declared signals (no values are stored)"""
+        print("\nAvailable signals:")
+        for sig_name in sorted(self.vcd.signal_data.keys()):
+            print(f"  {sig_name}")
+
+
 def main():
     parser = argparse.ArgumentParser(
         description="Analyze VCD waveform traces from VGA Nyancat simulation"
@@ -354,10 +783,25 @@ def main():
     parser.add_argument(
         "--signals", action="store_true", help="List all signals in VCD file"
     )
+    parser.add_argument(
+        "--stream",
+        action="store_true",
+        help="Single-pass constant-memory analysis (same report)",
+    )
+    parser.add_argument(
+        "--jobs",
+        type=int,
+        default=1,
+        metavar="N",
+        help="Analyze time-aligned chunks in N worker processes (implies --stream)",
+    )
 
     args = parser.parse_args()
 
-    analyzer = VGATimingAnalyzer(args.vcd_file)
+    if args.stream or args.jobs > 1:
+        analyzer = StreamingVGATimingAnalyzer(args.vcd_file, args.jobs)
+    else:
+        analyzer = VGATimingAnalyzer(args.vcd_file)
 
     if not analyzer.parse_vcd():
         print("Error: Failed to parse VCD file")
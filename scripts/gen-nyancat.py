@@ -9,6 +9,27 @@ character indices. Hardware performs scaling and color lookup.
 Input:  animation.c from nyancat project
 Output: nyancat-frames.hex (compressed format)
         nyancat-colors.hex (color palette)
+        nyancat-rle.hex, nyancat-rle-index.hex, nyancat-rle.vh
+            (run-length frame ROM for NYANCAT_FRAME_RLE builds)
+        nyancat-key.hex, nyancat-delta.hex, nyancat-delta-index.hex,
+        nyancat-delta.vh
+            (keyframe and delta lists for NYANCAT_FRAME_DELTA builds)
+
+Run-length encoding: every source row is a list of 8-bit words
+{run length - 1 [7:4], character index [3:0]}. Runs hold at most 16
+pixels and never cross a row, so the hardware decodes any row on its own
+from its entry in the index ROM (first word of frame f, row y at index
+f * 64 + y). nyancat-rle.vh carries the resulting ROM sizes for nyancat.v.
+
+Delta encoding: frame 0 is the keyframe (the initial content of the
+hardware frame buffer) and list f holds the pixels that change from frame
+f to frame f + 1 (the last list wraps back to frame 0), one 16-bit word
+{pixel address [15:4], character index [3:0]} each. The delta index holds
+the first word of every list plus the total, so list f spans
+index[f] .. index[f + 1] - 1. nyancat-delta.vh carries the sizes and the
+longest list.
+
+With --report only the ROM size comparison is printed (no files written).
 """
 
 import re
@@ -35,6 +56,12 @@ COLOR_MAP = {
     "%": (255, 163, 152),  # 13: Pink cheeks
 }
 
+FRAME_W = 64
+FRAME_H = 64
+INDEX_BITS = 4  # Character index width (nyancat-frames.hex entry)
+RLE_RUN_BITS = 4  # Run length field of a nyancat-rle.hex word
+DELTA_WORD_BITS = 16  # nyancat-delta.hex word: 12-bit address + index
+
 
 def rgb_to_vga6(r, g, b):
     """Convert 8-bit RGB to 6-bit VGA format (2R2G2B)."""
@@ -70,16 +97,176 @@ def parse_animation_c(filepath):
     return frames
 
 
+def frame_rows(frames, char_to_idx):
+    """Character index rows of all frames, frame by frame."""
+    rows = []
+    for frame_num, lines in frames:
+        if len(lines) != FRAME_H or any(len(line) != FRAME_W for line in lines):
+            print(f"Error: frame {frame_num} is not {FRAME_W}x{FRAME_H}")
+            sys.exit(1)
+        for line in lines:
+            rows.append([char_to_idx.get(char, 0) for char in line])
+    return rows
+
+
+def rle_encode_row(row, run_bits=RLE_RUN_BITS):
+    """Encode one row as [length, index] runs of at most 2**run_bits pixels."""
+    max_run = 1 << run_bits
+    runs = []
+    for idx in row:
+        if runs and runs[-1][1] == idx and runs[-1][0] < max_run:
+            runs[-1][0] += 1
+        else:
+            runs.append([1, idx])
+    return runs
+
+
+def rle_rom_size(rows, run_bits=RLE_RUN_BITS):
+    """(data words, index address width, total ROM bits) of an encoding."""
+    words = sum(len(rle_encode_row(row, run_bits)) for row in rows)
+    addr_bits = max(1, (words - 1).bit_length())
+    return words, addr_bits, words * (run_bits + INDEX_BITS) + len(rows) * addr_bits
+
+
+def delta_lists(rows):
+    """Per-step [address, index] lists of changed pixels, cyclic."""
+    pixels = [sum(rows[n : n + FRAME_H], []) for n in range(0, len(rows), FRAME_H)]
+    lists = []
+    for n, frame in enumerate(pixels):
+        following = pixels[(n + 1) % len(pixels)]
+        lists.append([[addr, new] for addr, (old, new) in enumerate(zip(frame, following)) if old != new])
+    return lists
+
+
+def delta_rom_size(rows):
+    """(data words, index address width, total bits incl. keyframe buffer)."""
+    lists = delta_lists(rows)
+    words = sum(len(changes) for changes in lists)
+    addr_bits = max(1, words.bit_length())
+    key_bits = FRAME_W * FRAME_H * INDEX_BITS
+    return words, addr_bits, key_bits + words * DELTA_WORD_BITS + (len(lists) + 1) * addr_bits
+
+
+def print_rom_report(rows):
+    """Compare the frame ROM size of the raw, run-length and delta encodings."""
+    raw_bits = len(rows) * FRAME_W * INDEX_BITS
+    print(f"\nFrame ROM size ({len(rows) // FRAME_H} frames):")
+    print(f"  {'encoding':<18} {'data':>13} {'index':>11} {'total bits':>11} {'saved':>7}")
+    print(f"  {'raw':<18} {len(rows) * FRAME_W:>7} x {INDEX_BITS:>2}b {'-':>11} {raw_bits:>11} {'-':>7}")
+    # The hardware decoder uses RLE_RUN_BITS; neighbours shown for reference
+    for run_bits in range(2, 7):
+        words, addr_bits, bits = rle_rom_size(rows, run_bits)
+        name = f"rle {run_bits}b run" + (" (used)" if run_bits == RLE_RUN_BITS else "")
+        saved = 100.0 * (raw_bits - bits) / raw_bits
+        print(
+            f"  {name:<18} {words:>7} x {run_bits + INDEX_BITS:>2}b "
+            f"{len(rows):>5} x {addr_bits:>2}b {bits:>11} {saved:>6.1f}%"
+        )
+    words, addr_bits, bits = delta_rom_size(rows)
+    saved = 100.0 * (raw_bits - bits) / raw_bits
+    steps = len(rows) // FRAME_H
+    print(
+        f"  {'delta':<18} {words:>7} x {DELTA_WORD_BITS:>2}b "
+        f"{steps + 1:>5} x {addr_bits:>2}b {bits:>11} {saved:>6.1f}%"
+    )
+    key_bits = FRAME_W * FRAME_H * INDEX_BITS
+    print(
+        f"  (delta total: {bits - key_bits} ROM bits of lists and index, plus the "
+        f"{FRAME_W}x{FRAME_H} x {INDEX_BITS}b = {key_bits}-bit keyframe / frame buffer)"
+    )
+
+
+def write_rle(rows, frames, output_dir):
+    """Write the run-length frame ROM, its row index and the size header."""
+    data_file = output_dir / "nyancat-rle.hex"
+    index_file = output_dir / "nyancat-rle-index.hex"
+    header_file = output_dir / "nyancat-rle.vh"
+
+    index = []
+    print(f"Writing {data_file}...")
+    with open(data_file, "w") as f:
+        words = 0
+        for n, row in enumerate(rows):
+            if n % FRAME_H == 0:
+                f.write(f"// Frame {frames[n // FRAME_H][0]}\n")
+            index.append(words)
+            for length, idx in rle_encode_row(row):
+                f.write(f"{(length - 1) << INDEX_BITS | idx:02x}\n")
+                words += 1
+
+    addr_bits = max(1, (words - 1).bit_length())
+    digits = (addr_bits + 3) // 4
+    print(f"Writing {index_file}...")
+    with open(index_file, "w") as f:
+        for n, addr in enumerate(index):
+            if n % FRAME_H == 0:
+                f.write(f"// Frame {frames[n // FRAME_H][0]}\n")
+            f.write(f"{addr:0{digits}x}\n")
+
+    print(f"Writing {header_file}...")
+    with open(header_file, "w") as f:
+        f.write("// Run-length frame ROM geometry (generated by scripts/gen-nyancat.py)\n")
+        f.write(f"`define NYANCAT_RLE_WORDS {words}\n")
+        f.write(f"`define NYANCAT_RLE_ADDR_WIDTH {addr_bits}\n")
+
+
+def write_delta(rows, frames, output_dir):
+    """Write the keyframe, the per-step delta lists, their index and sizes."""
+    key_file = output_dir / "nyancat-key.hex"
+    data_file = output_dir / "nyancat-delta.hex"
+    index_file = output_dir / "nyancat-delta-index.hex"
+    header_file = output_dir / "nyancat-delta.vh"
+
+    print(f"Writing {key_file}...")
+    with open(key_file, "w") as f:
+        f.write(f"// Keyframe (frame {frames[0][0]})\n")
+        for row in rows[:FRAME_H]:
+            for idx in row:
+                f.write(f"{idx:x}\n")
+
+    lists = delta_lists(rows)
+    index = []
+    print(f"Writing {data_file}...")
+    with open(data_file, "w") as f:
+        words = 0
+        for n, changes in enumerate(lists):
+            following = frames[(n + 1) % len(frames)][0]
+            f.write(f"// Frame {frames[n][0]} -> {following}: {len(changes)} pixels\n")
+            index.append(words)
+            for addr, idx in changes:
+                f.write(f"{addr << INDEX_BITS | idx:04x}\n")
+                words += 1
+        index.append(words)
+        if words == 0:
+            f.write("0000  // Padding: every frame is identical\n")
+
+    addr_bits = max(1, words.bit_length())
+    digits = (addr_bits + 3) // 4
+    print(f"Writing {index_file}...")
+    with open(index_file, "w") as f:
+        for addr in index:
+            f.write(f"{addr:0{digits}x}\n")
+
+    print(f"Writing {header_file}...")
+    with open(header_file, "w") as f:
+        f.write("// Delta frame ROM geometry (generated by scripts/gen-nyancat.py)\n")
+        f.write(f"`define NYANCAT_DELTA_WORDS {max(1, words)}\n")
+        f.write(f"`define NYANCAT_DELTA_ADDR_WIDTH {addr_bits}\n")
+        f.write(f"`define NYANCAT_DELTA_MAX {max(len(changes) for changes in lists)}\n")
+
+
 def main():
-    if len(sys.argv) < 2:
-        print(f"Usage: {sys.argv[0]} <animation.c> [output_dir]")
+    args = [arg for arg in sys.argv[1:] if arg != "--report"]
+    report_only = len(args) != len(sys.argv) - 1
+    if len(args) < 1:
+        print(f"Usage: {sys.argv[0]} [--report] <animation.c> [output_dir]")
         sys.exit(1)
 
-    input_file = Path(sys.argv[1])
+    input_file = Path(args[0])
 
     # Use specified output directory or default to rtl/
-    if len(sys.argv) >= 3:
-        output_dir = Path(sys.argv[2])
+    if len(args) >= 2:
+        output_dir = Path(args[1])
     else:
         output_dir = Path(__file__).parent.parent / "rtl"
 
@@ -98,6 +285,11 @@ def main():
     char_to_idx = build_char_to_index()
     print(f"Character palette: {len(char_to_idx)} colors")
 
+    rows = frame_rows(frames, char_to_idx)
+    if report_only:
+        print_rom_report(rows)
+        return
+
     # Write color palette
     print(f"\nWriting {colors_file}...")
     with open(colors_file, "w") as f:
@@ -122,11 +314,15 @@ def main():
                     f.write(f"{idx:x}\n")
                     total_pixels += 1
 
+    write_rle(rows, frames, output_dir)
+    write_delta(rows, frames, output_dir)
+
     frames_kb = total_pixels / 1024
     print(f"\nDone! Generated {len(frames)} frames")
     print(f"Frame size: 64x64 pixels")
     print(f"Total: {total_pixels} pixels ({frames_kb:.1f} KB)")
     print(f"Color palette: {len(COLOR_MAP)} colors")
+    print_rom_report(rows)
 
 
 if __name__ == "__main__":
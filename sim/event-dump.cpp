@@ -0,0 +1,176 @@
+// VGA Nyancat is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+//
+// Reader/dumper for the binary event log written by 'sim --event-log'
+//
+// Prints one line per record with the clock stamp expanded into a frame
+// number and a line:column offset from that frame's vsync falling edge
+// (using the H_TOTAL stored in the log header), or with --summary only the
+// per-type counts, sync periods in clocks and validator errors.
+//
+// Usage: event-dump <events.bin> [--summary]
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "event-log.h"
+
+// Running min/avg/max of the distance between falling edges of one sync
+struct PeriodStats {
+    bool seen = false, value = false;
+    uint64_t last_fall = 0, falls = 0;
+    uint64_t count = 0, sum = 0, min = UINT64_MAX, max = 0;
+
+    // Level from a sync record (the first one is the initial level)
+    void level(uint64_t clock, bool v)
+    {
+        bool fall = seen && value && !v;
+        seen = true;
+        value = v;
+        if (!fall)
+            return;
+        if (falls > 0) {
+            uint64_t p = clock - last_fall;
+            count++;
+            sum += p;
+            min = std::min(min, p);
+            max = std::max(max, p);
+        }
+        falls++;
+        last_fall = clock;
+    }
+
+    void print(const char *name) const
+    {
+        if (!count) {
+            printf("  %-6s %" PRIu64 " falling edges (no full period)\n", name,
+                   falls);
+            return;
+        }
+        printf("  %-6s %" PRIu64 " falling edges, period min %" PRIu64
+               " / avg %.2f / max %" PRIu64 " clocks\n",
+               name, falls, min, double(sum) / count, max);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const char *filename = nullptr;
+    bool summary = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--summary") == 0)
+            summary = true;
+        else if (!filename && argv[i][0] != '-')
+            filename = argv[i];
+        else {
+            fprintf(stderr, "Usage: %s <events.bin> [--summary]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!filename) {
+        fprintf(stderr, "Usage: %s <events.bin> [--summary]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        fprintf(stderr, "Error: cannot open %s\n", filename);
+        return 1;
+    }
+
+    EventLogHeader h;
+    if (fread(&h, sizeof(h), 1, fp) != 1 ||
+        memcmp(h.magic, EVENT_LOG_MAGIC, sizeof(h.magic)) != 0) {
+        fprintf(stderr, "Error: %s is not an event log\n", filename);
+        fclose(fp);
+        return 1;
+    }
+    if (h.version != EVENT_LOG_VERSION ||
+        h.record_size != sizeof(EventRecord) || h.h_total == 0 ||
+        h.v_total == 0) {
+        fprintf(stderr,
+                "Error: unsupported event log (version %u, %u-byte "
+                "records)\n",
+                h.version, h.record_size);
+        fclose(fp);
+        return 1;
+    }
+    h.mode_name[sizeof(h.mode_name) - 1] = '\0';
+    printf("Event log: %s (%s, %ux%u, %ux%u total)\n", filename, h.mode_name,
+           h.h_res, h.v_res, h.h_total, h.v_total);
+
+    uint64_t frame = 0, frame_clock = 0;  // Last FRAME_START
+    uint64_t counts[EventLog::NUM_TYPES] = {};
+    uint64_t errors[EventLog::NUM_SOURCES] = {};
+    uint64_t records = 0, end_clock = 0;
+    bool ended = false;
+    PeriodStats hsync, vsync;
+
+    EventRecord buf[EventLog::BUFFER_RECORDS];
+    size_t n;
+    while ((n = fread(buf, sizeof(EventRecord), EventLog::BUFFER_RECORDS,
+                      fp)) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            const EventRecord &r = buf[i];
+            records++;
+            if (r.type < EventLog::NUM_TYPES)
+                counts[r.type]++;
+            if (r.type == EventLog::HSYNC)
+                hsync.level(r.clock, r.payload);
+            else if (r.type == EventLog::VSYNC)
+                vsync.level(r.clock, r.payload);
+            else if (r.type == EventLog::VALIDATOR_ERROR &&
+                     r.source < EventLog::NUM_SOURCES)
+                errors[r.source] = r.payload;
+            else if (r.type == EventLog::FRAME_START) {
+                frame = r.payload;
+                frame_clock = r.clock;
+            } else if (r.type == EventLog::END) {
+                ended = true;
+                end_clock = r.clock;
+            }
+            if (summary)
+                continue;
+
+            uint64_t in_frame = r.clock - frame_clock;
+            printf("%12" PRIu64 "  f%-4" PRIu64 " %4" PRIu64 ":%-4" PRIu64
+                   "  %-15s",
+                   r.clock, frame, in_frame / h.h_total, in_frame % h.h_total,
+                   EventLog::type_name(r.type));
+            if (r.type == EventLog::VALIDATOR_ERROR)
+                printf(" %s total=%u", EventLog::source_name(r.source),
+                       r.payload);
+            else if (r.type != EventLog::END)
+                printf(" %u", r.payload);
+            printf("\n");
+        }
+    }
+    fclose(fp);
+
+    if (summary) {
+        printf("\nRecords: %" PRIu64 "\n", records);
+        for (int t = 0; t < EventLog::NUM_TYPES; ++t)
+            printf("  %-15s %" PRIu64 "\n", EventLog::type_name(t), counts[t]);
+        printf("\nSync periods:\n");
+        hsync.print("hsync");
+        vsync.print("vsync");
+        printf("\nValidator errors:");
+        bool any = false;
+        for (int s = 0; s < EventLog::NUM_SOURCES; ++s) {
+            if (errors[s]) {
+                printf(" %s=%" PRIu64, EventLog::source_name(s), errors[s]);
+                any = true;
+            }
+        }
+        printf("%s\n", any ? "" : " none");
+    }
+
+    if (!ended) {
+        fprintf(stderr, "Warning: no END record (log truncated)\n");
+        return 1;
+    }
+    printf("Clocks logged: %" PRIu64 "\n", end_clock);
+    return 0;
+}
@@ -0,0 +1,218 @@
+// VGA Nyancat is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+//
+// Compact binary sync/event log
+//
+// A low-overhead alternative to VCD for timing questions: instead of every
+// signal on every clock, only the events below are stored, each as one
+// fixed-size record (clock stamp + event type + payload):
+//   HSYNC, VSYNC, ACTIVEVIDEO  port transition, payload = new level
+//   FRAME_START                vsync falling edge, payload = frame number
+//   FRAME_INDEX                nyancat frame_index change, payload = index
+//   VALIDATOR_ERROR            validator error count grew, source = checker,
+//                              payload = its new total
+//   END                        last record, payload unused (clock = total)
+// The first observed clock logs the initial level of every signal.
+//
+// File layout: one EventLogHeader, then EventRecords in clock order. All
+// fields are little-endian host order (the dumper checks the magic and
+// record size). A frame of VGA 640x480 is ~2k records (~32 KiB) against
+// tens of MB of VCD.
+//
+// Records are staged in a BUFFER_RECORDS buffer and written with one
+// fwrite() per full buffer, so per-clock cost is a few compares.
+//
+// Standalone (no Verilator or videomode.h dependency) so that the
+// event-dump reader can share the format definition.
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct EventLogHeader {
+    char magic[8];         // EVENT_LOG_MAGIC
+    uint32_t version;      // EVENT_LOG_VERSION
+    uint32_t record_size;  // sizeof(EventRecord)
+    uint32_t h_res, v_res;
+    uint32_t h_total, v_total;
+    char mode_name[32];  // NUL-terminated
+};
+
+struct EventRecord {
+    uint64_t clock;  // Clocks since reset release
+    uint8_t type;    // EventLog::Type
+    uint8_t source;  // EventLog::Source (VALIDATOR_ERROR only)
+    uint16_t reserved;
+    uint32_t payload;
+};
+
+static_assert(sizeof(EventLogHeader) == 64, "event log header layout");
+static_assert(sizeof(EventRecord) == 16, "event log record layout");
+
+static constexpr char EVENT_LOG_MAGIC[8] = {'N', 'Y', 'A', 'N',
+                                            'E', 'V', 'T', '\0'};
+static constexpr uint32_t EVENT_LOG_VERSION = 1;
+
+class EventLog
+{
+public:
+    enum Type {
+        HSYNC,
+        VSYNC,
+        ACTIVEVIDEO,
+        FRAME_START,
+        FRAME_INDEX,
+        VALIDATOR_ERROR,
+        END,
+        NUM_TYPES
+    };
+
+    enum Source {
+        SRC_TIMING,       // --validate-timing
+        SRC_SIGNALS,      // --validate-signals
+        SRC_COORDINATES,  // --validate-coordinates
+        SRC_ALIGNMENT,    // --validate-alignment
+        SRC_LOCKSTEP,     // --lockstep
+        NUM_SOURCES
+    };
+
+    static constexpr size_t BUFFER_RECORDS = 4096;  // 64 KiB per fwrite()
+
+    static const char *type_name(unsigned type)
+    {
+        static const char *names[NUM_TYPES] = {
+            "HSYNC",       "VSYNC",           "ACTIVEVIDEO", "FRAME_START",
+            "FRAME_INDEX", "VALIDATOR_ERROR", "END",
+        };
+        return type < NUM_TYPES ? names[type] : "?";
+    }
+
+    static const char *source_name(unsigned source)
+    {
+        static const char *names[NUM_SOURCES] = {
+            "timing", "signals", "coordinates", "alignment", "lockstep",
+        };
+        return source < NUM_SOURCES ? names[source] : "?";
+    }
+
+    EventLog() { buffer.reserve(BUFFER_RECORDS); }
+    ~EventLog() { close(); }
+
+    bool open(const char *filename,
+              const char *mode_name,
+              int h_res,
+              int v_res,
+              int h_total,
+              int v_total)
+    {
+        fp = fopen(filename, "wb");
+        if (!fp)
+            return false;
+        EventLogHeader h = {};
+        memcpy(h.magic, EVENT_LOG_MAGIC, sizeof(h.magic));
+        h.version = EVENT_LOG_VERSION;
+        h.record_size = sizeof(EventRecord);
+        h.h_res = h_res;
+        h.v_res = v_res;
+        h.h_total = h_total;
+        h.v_total = v_total;
+        strncpy(h.mode_name, mode_name, sizeof(h.mode_name) - 1);
+        ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+        return ok;
+    }
+
+    // Observe one clock (after the rising edge)
+    void tick(bool hsync, bool vsync, bool activevideo, uint8_t frame_index)
+    {
+        if (clock == 0) {
+            emit(HSYNC, hsync);
+            emit(VSYNC, vsync);
+            emit(ACTIVEVIDEO, activevideo);
+            emit(FRAME_INDEX, frame_index);
+        } else {
+            if (hsync != prev_hsync)
+                emit(HSYNC, hsync);
+            if (vsync != prev_vsync) {
+                emit(VSYNC, vsync);
+                if (!vsync)
+                    emit(FRAME_START, ++frames);
+            }
+            if (activevideo != prev_active)
+                emit(ACTIVEVIDEO, activevideo);
+            if (frame_index != prev_frame_index)
+                emit(FRAME_INDEX, frame_index);
+        }
+        prev_hsync = hsync;
+        prev_vsync = vsync;
+        prev_active = activevideo;
+        prev_frame_index = frame_index;
+        clock++;
+    }
+
+    // Report a checker's running error total for the clock just ticked
+    void errors(Source source, uint64_t total)
+    {
+        if (total > error_totals[source]) {
+            error_totals[source] = total;
+            emit(VALIDATOR_ERROR, (uint32_t) total, source, clock - 1);
+        }
+    }
+
+    // Write the END record and flush; safe to call more than once
+    void close()
+    {
+        if (!fp)
+            return;
+        emit(END, 0, 0, clock);
+        flush();
+        ok &= fclose(fp) == 0;
+        fp = nullptr;
+    }
+
+    bool good() const { return ok; }
+    uint64_t clocks() const { return clock; }
+    uint64_t records() const { return record_count; }
+    uint64_t bytes() const
+    {
+        return sizeof(EventLogHeader) + record_count * sizeof(EventRecord);
+    }
+
+private:
+    FILE *fp = nullptr;
+    bool ok = false;
+    std::vector<EventRecord> buffer;
+    uint64_t clock = 0, frames = 0, record_count = 0;
+    uint64_t error_totals[NUM_SOURCES] = {};
+    bool prev_hsync = false, prev_vsync = false, prev_active = false;
+    uint8_t prev_frame_index = 0;
+
+    void emit(Type type, uint32_t payload)
+    {
+        emit(type, payload, 0, clock);
+    }
+
+    void emit(Type type, uint32_t payload, uint8_t source, uint64_t at)
+    {
+        if (!fp)
+            return;
+        buffer.push_back({at, (uint8_t) type, source, 0, payload});
+        record_count++;
+        if (buffer.size() == BUFFER_RECORDS)
+            flush();
+    }
+
+    void flush()
+    {
+        if (!buffer.empty() &&
+            fwrite(buffer.data(), sizeof(EventRecord), buffer.size(), fp) !=
+                buffer.size())
+            ok = false;
+        buffer.clear();
+    }
+};
+
+#endif  // EVENT_LOG_H
@@ -12,63 +12,131 @@
 //   4. SDL texture refreshed once per frame for display
 
 #include <SDL.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <string>
 #include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc() for HostProfiler
+#endif
 
+// Single-mode builds link one model (Vvga_nyancat) elaborated for the
+// VIDEO_MODE_* define; the all-modes build (SIM_ALL_MODES) links one model
+// per video mode, each Verilated with its own --prefix, and picks one at
+// runtime (--mode). rootp headers expose the public_flat_rd internals.
+#ifndef SIM_ALL_MODES
+#define SIM_ALL_MODES 0
+#endif
+#if SIM_ALL_MODES
+#include "Vvga_nyancat_SVGA_800x600_72.h"
+#include "Vvga_nyancat_SVGA_800x600_72___024root.h"
+#include "Vvga_nyancat_VGA_640x480_60.h"
+#include "Vvga_nyancat_VGA_640x480_60___024root.h"
+#include "Vvga_nyancat_VGA_640x480_72.h"
+#include "Vvga_nyancat_VGA_640x480_72___024root.h"
+#include "Vvga_nyancat_VGA_800x600_60.h"
+#include "Vvga_nyancat_VGA_800x600_60___024root.h"
+#include "Vvga_nyancat_XGA_1024x768_60.h"
+#include "Vvga_nyancat_XGA_1024x768_60___024root.h"
+#else
 #include "Vvga_nyancat.h"
+#include "Vvga_nyancat___024root.h"
+#endif
 #include "verilated.h"
+
+// VM_TRACE is set by the Verilator-generated makefile: 1 for the checked
+// build (--trace) and the FST build (--trace-fst), 0 for the fast build;
+// VM_TRACE_FST selects the FST writer. Without tracing the model has no
+// trace() hook and no writer is linked, so a no-op stand-in keeps the call
+// sites below uniform.
+#ifndef VM_TRACE_FST
+#define VM_TRACE_FST 0
+#endif
+#if VM_TRACE && VM_TRACE_FST
+#include "gtkwave/fstapi.h"    // Raw FST writer for triggered traces
+#include "verilated_fst_c.h"  // For FST waveform tracing
+typedef VerilatedFstC TraceWriter;
+#define TRACE_FORMAT "FST"
+#elif VM_TRACE
+#include "trace-file.h"       // VCD sink with background compression
 #include "verilated_vcd_c.h"  // For VCD waveform tracing
+typedef VerilatedVcdC TraceWriter;
+#define TRACE_FORMAT "VCD"
+#define TRACE_COMPRESSION 1
+#else
+class TraceWriter
+{
+public:
+    void open(const char *) {}
+    void dump(vluint64_t) {}
+    void close() {}
+};
+#define TRACE_FORMAT "none"
+#endif
+#ifndef TRACE_COMPRESSION
+#define TRACE_COMPRESSION 0
+#endif
+
+// Compressed VCD output (*.vcd.gz / *.vcd.zst) is decided by file name
+static bool is_compressed_trace(const char *filename)
+{
+    size_t n = strlen(filename);
+    return (n > 3 && strcmp(filename + n - 3, ".gz") == 0) ||
+           (n > 4 && strcmp(filename + n - 4, ".zst") == 0);
+}
 
 // Video mode configuration (must match RTL videomode.vh settings)
-// Default: VGA 640×480 @ 72Hz
-// To use different modes, define VIDEO_MODE_* in Makefile and recompile
-
-#if !defined(VIDEO_MODE_VGA_640x480_72) &&  \
-    !defined(VIDEO_MODE_VGA_640x480_60) &&  \
-    !defined(VIDEO_MODE_VGA_800x600_60) &&  \
-    !defined(VIDEO_MODE_SVGA_800x600_72) && \
-    !defined(VIDEO_MODE_XGA_1024x768_60)
-// Default to VGA 640×480 @ 72Hz if no mode specified
-#define VIDEO_MODE_VGA_640x480_72
+// Host-side classes are templated on the mode traits (Mode_* structs)
+#include "videomode.h"
+
+#include "nyancat-model.h"
+
+#include "event-log.h"  // Binary sync/event log (--event-log)
+
+// External frame memory build (make FRAME_MEM=wishbone passes the same
+// define to Verilator and to this file): the Verilated model has a Wishbone
+// read port that the harness answers with a WishboneMemory slave model
+#ifndef NYANCAT_FRAME_MEM_WB
+#define NYANCAT_FRAME_MEM_WB 0
+#endif
+#include "wishbone-mem.h"
+
+// On-chip frame CRC build (make FRAME_CRC=1 passes the same define to
+// Verilator and to this file): vga_nyancat has frame_crc/frame_crc_valid
+// ports that --frame-crc checks against the framebuffer
+#ifndef NYANCAT_FRAME_CRC
+#define NYANCAT_FRAME_CRC 0
 #endif
 
-// Video mode timing parameters (must match videomode.vh)
-#if defined(VIDEO_MODE_VGA_640x480_72)
-constexpr int H_RES = 640, V_RES = 480;
-constexpr int H_FP = 24, H_SYNC = 40, H_BP = 128;
-constexpr int V_FP = 9, V_SYNC = 3, V_BP = 28;
-constexpr const char *MODE_NAME = "VGA 640x480 @ 72Hz";
-#elif defined(VIDEO_MODE_VGA_640x480_60)
-constexpr int H_RES = 640, V_RES = 480;
-constexpr int H_FP = 16, H_SYNC = 96, H_BP = 48;
-constexpr int V_FP = 10, V_SYNC = 2, V_BP = 33;
-constexpr const char *MODE_NAME = "VGA 640x480 @ 60Hz";
-#elif defined(VIDEO_MODE_VGA_800x600_60)
-constexpr int H_RES = 800, V_RES = 600;
-constexpr int H_FP = 40, H_SYNC = 128, H_BP = 88;
-constexpr int V_FP = 1, V_SYNC = 4, V_BP = 23;
-constexpr const char *MODE_NAME = "SVGA 800x600 @ 60Hz";
-#elif defined(VIDEO_MODE_SVGA_800x600_72)
-constexpr int H_RES = 800, V_RES = 600;
-constexpr int H_FP = 56, H_SYNC = 120, H_BP = 64;
-constexpr int V_FP = 37, V_SYNC = 6, V_BP = 23;
-constexpr const char *MODE_NAME = "SVGA 800x600 @ 72Hz";
-#elif defined(VIDEO_MODE_XGA_1024x768_60)
-constexpr int H_RES = 1024, V_RES = 768;
-constexpr int H_FP = 24, H_SYNC = 136, H_BP = 160;
-constexpr int V_FP = 3, V_SYNC = 6, V_BP = 29;
-constexpr const char *MODE_NAME = "XGA 1024x768 @ 60Hz";
+// Pixels per clock of the RTL build (make PIXELS_PER_CLOCK=2 passes the same
+// define to Verilator and to this file). The Verilated model then carries one
+// 6-bit color per lane in rrggbb, lane 0 (left pixel) in bits [5:0]; the
+// reference model always renders one pixel per eval.
+#ifndef PIXELS_PER_CLOCK
+#define PIXELS_PER_CLOCK 1
 #endif
 
-// Computed timing values
-constexpr int H_BLANKING = H_FP + H_SYNC + H_BP;
-constexpr int V_BLANKING = V_FP + V_SYNC + V_BP;
-constexpr int H_TOTAL = H_RES + H_BLANKING;
-constexpr int V_TOTAL = V_RES + V_BLANKING;
-constexpr int CLOCKS_PER_FRAME = H_TOTAL * V_TOTAL;
+template <typename Top>
+struct TopLanes {
+    static constexpr int value = PIXELS_PER_CLOCK;
+};
+
+template <typename Mode>
+struct TopLanes<NyancatModel<Mode>> {
+    static constexpr int value = 1;
+};
+
+// Color of one pixel lane of the current eval
+template <typename Top>
+inline uint8_t lane_rrggbb(const Top *top, int lane)
+{
+    return (top->rrggbb >> (6 * lane)) & 0x3f;
+}
 
 // Color conversion: 2-bit VGA channel → 8-bit RGB
 // Maps 2-bit color values to 8-bit with even spacing:
@@ -95,9 +163,12 @@ constexpr uint8_t vga2bit_to_8bit(uint8_t val)
 //   - Tolerance: ±1 clock/line for jitter handling
 //   - Validate at edge boundaries (avoid continuous counting errors)
 //   - Silent mode: only report first frame errors (avoid spam)
+template <typename Mode>
 class TimingMonitor
 {
 private:
+    USE_VIDEO_MODE(Mode);
+
     const int expected_h_sync = H_SYNC, expected_v_sync = V_SYNC;
     const int expected_h_total = H_TOTAL, expected_v_total = V_TOTAL;
     const int expected_h_active = H_RES, expected_v_active = V_RES;
@@ -316,6 +387,12 @@ public:
                 v_active_errors > 0);
     }
 
+    int get_total_errors() const
+    {
+        return hsync_errors + vsync_errors + h_total_errors + v_total_errors +
+               h_active_errors + v_active_errors;
+    }
+
     bool is_complete() const { return frame_complete; }
 };
 
@@ -329,9 +406,12 @@ public:
 //   - Detect unexpected edges (glitches) between valid pulse boundaries
 //   - Report errors with phase context (active/blanking region)
 //   - Silent after first frame to avoid spam
+template <typename Mode>
 class SyncValidator
 {
 private:
+    USE_VIDEO_MODE(Mode);
+
     struct PulseTracker {
         int pulse_width;      // Current pulse width (clocks or lines)
         int since_last_edge;  // Clocks/lines since last edge
@@ -530,9 +610,12 @@ public:
 //   - Accumulate error count and auto-stop at threshold (10 errors)
 //   - Report errors with coordinate context for debugging
 //   - Silent after first frame to avoid spam
+template <typename Mode>
 class CoordinateValidator
 {
 private:
+    USE_VIDEO_MODE(Mode);
+
     int error_count = 0;
     bool silent_mode = false;
     bool frame_complete = false;
@@ -639,9 +722,12 @@ public:
 //   - Heat map tracking for temporal analysis of change patterns
 //   - Track statistics: changed pixels, change rate, hotspots
 //   - Provide bounding box calculation for minimal update regions
+template <typename Mode>
 class ChangeTracker
 {
 private:
+    USE_VIDEO_MODE(Mode);
+
     // Tile-based tracking configuration
     static constexpr int TILE_SIZE = 32;  // 32×32 pixel tiles
     static constexpr int TILES_X = (H_RES + TILE_SIZE - 1) / TILE_SIZE;
@@ -902,31 +988,102 @@ public:
 //   - Classify clocks: blanking vs active vs rendered
 //   - Calculate utilization rates for performance analysis
 //   - Provide data-driven baseline for optimization decisions
+//
+// Breakdowns:
+//   - Per-scanline rendered counts (active line index, summed over frames)
+//   - Histogram over the 64 rrggbb values during active video
+//   - Per-frame rows delimited by vsync falling edges; the trailing row is
+//     marked incomplete when the run ends before its last active line
+//   - Expected display area derived from the mode's SCALE (nyancat.v)
+//   - dump() writes the breakdowns as CSV or JSON for offline analysis
+template <typename Mode>
 class RenderProfiler
 {
 private:
+    USE_VIDEO_MODE(Mode);
+
+    static constexpr int NUM_COLORS = 64;  // 6-bit rrggbb
+
+    struct FrameRow {
+        uint64_t clocks;
+        uint64_t blank_clocks;
+        uint64_t active_black_clocks;
+        uint64_t rendered_clocks;
+        uint64_t frame_rom_reads;
+        uint64_t palette_rom_reads;
+        bool complete;
+    };
+
     uint64_t total_clocks = 0;
     uint64_t blank_clocks = 0;         // !activevideo
     uint64_t active_black_clocks = 0;  // activevideo && (rrggbb == 0)
     uint64_t rendered_clocks = 0;      // activevideo && (rrggbb != 0)
+    uint64_t frame_rom_reads = 0;      // nyancat frame_mem read enables
+    uint64_t palette_rom_reads = 0;    // nyancat color_mem read enables
     bool frame_complete = false;
 
+    uint64_t color_hist[NUM_COLORS] = {};    // Active clocks per rrggbb
+    std::vector<uint64_t> line_rendered;     // Rendered clocks per scanline
+    std::vector<FrameRow> frames;            // Completed frame rows
+    FrameRow current = {};                   // Frame in progress
+    bool frame_started = false;              // Seen first vsync edge
+    int active_line = -1;
+    bool prev_vsync = true, prev_active = false;
+
+    void close_frame(bool complete)
+    {
+        current.complete = complete;
+        frames.push_back(current);
+        current = {};
+    }
+
 public:
-    RenderProfiler() = default;
+    RenderProfiler() : line_rendered(V_RES, 0) {}
 
     // Track one clock cycle
     // Call this for every pixel clock in the simulation
-    void tick(bool activevideo, uint8_t rrggbb)
+    void tick(bool vsync,
+              bool activevideo,
+              uint8_t rrggbb,
+              bool frame_rom_rd,
+              bool palette_rom_rd)
     {
         total_clocks++;
 
+        // Frame boundary: vsync falling edge closes the current row
+        if (!vsync && prev_vsync) {
+            if (frame_started)
+                close_frame(true);
+            else
+                current = {};  // Drop pre-sync clocks
+            frame_started = true;
+            active_line = -1;
+        }
+        prev_vsync = vsync;
+
+        // Scanline boundary: activevideo rising edge
+        if (activevideo && !prev_active)
+            active_line++;
+        prev_active = activevideo;
+
+        current.clocks++;
+        frame_rom_reads += frame_rom_rd;
+        palette_rom_reads += palette_rom_rd;
+        current.frame_rom_reads += frame_rom_rd;
+        current.palette_rom_reads += palette_rom_rd;
         if (!activevideo) {
             blank_clocks++;
+            current.blank_clocks++;
         } else {
+            color_hist[rrggbb & (NUM_COLORS - 1)]++;
             if (rrggbb == 0) {
                 active_black_clocks++;
+                current.active_black_clocks++;
             } else {
                 rendered_clocks++;
+                current.rendered_clocks++;
+                if (active_line >= 0 && active_line < V_RES)
+                    line_rendered[active_line]++;
             }
         }
     }
@@ -934,6 +1091,15 @@ public:
     // Mark frame completion (optional, for multi-frame statistics)
     void mark_frame_complete() { frame_complete = true; }
 
+    // Finalize per-frame rows: keep the trailing frame as a row, complete
+    // if every active pixel of it was scanned out
+    void finish()
+    {
+        if (frame_started && current.clocks > 0)
+            close_frame(current.active_black_clocks + current.rendered_clocks >=
+                        (uint64_t) H_RES * V_RES);
+    }
+
     void report() const
     {
         if (total_clocks == 0) {
@@ -973,31 +1139,205 @@ public:
         std::cout << "  Blanking overhead:   " << blank_pct
                   << "% (sync + porches)\n\n";
 
-        // Expected vs measured for VGA 640×480 @ 72Hz
-        uint64_t expected_active = H_RES * V_RES;     // 640 × 480 = 307,200
-        uint64_t expected_total = H_TOTAL * V_TOTAL;  // 832 × 520 = 432,640
+        // Expected vs measured for the selected video mode
+        constexpr int SCALE = NyancatModel<Mode>::SCALE;
+        constexpr uint64_t display_area =
+            (uint64_t) NyancatModel<Mode>::SCALED_W *
+            NyancatModel<Mode>::SCALED_H;
+        uint64_t expected_active = H_RES * V_RES;
+        uint64_t expected_total = H_TOTAL * V_TOTAL;
         double theoretical_active_pct =
             (100.0 * expected_active) / expected_total;
 
-        std::cout << "Theoretical limits (VGA " << H_RES << "×" << V_RES
-                  << "):\n";
+        std::cout << "Theoretical limits (" << MODE_NAME << "):\n";
         std::cout << "  Max active: " << theoretical_active_pct << "% ("
                   << expected_active << "/" << expected_total << " pixels)\n";
-        std::cout << "  Nyancat display area: 512×512 = 262,144 pixels ("
-                  << (100.0 * 262144 / expected_active) << "% of active)\n";
+        std::cout << "  Nyancat display area: " << NyancatModel<Mode>::SCALED_W
+                  << "×" << NyancatModel<Mode>::SCALED_H << " (SCALE=" << SCALE
+                  << ") = " << display_area << " pixels ("
+                  << (100.0 * display_area / expected_active)
+                  << "% of active)\n";
         std::cout << "  Expected render rate: ~"
-                  << (100.0 * 262144 / expected_total)
+                  << (100.0 * display_area / expected_total)
                   << "% of total clocks\n\n";
 
         // Performance comparison
         double actual_vs_theoretical = rendered_pct / theoretical_active_pct;
         std::cout << "Performance vs theoretical:\n";
         std::cout << "  Actual render / Max active: "
-                  << (actual_vs_theoretical * 100.0) << "%\n";
+                  << (actual_vs_theoretical * 100.0) << "%\n\n";
+
+        // ROM activity: one read per display pixel without the line buffer,
+        // ~1/SCALE with it (NYANCAT_LINE_BUFFER)
+        std::cout << "ROM reads (frame_mem / color_mem):\n";
+        std::cout << "  Total: " << frame_rom_reads << " / "
+                  << palette_rom_reads << "\n";
+        uint64_t complete_frames = 0, complete_reads = 0;
+        for (const FrameRow &f : frames) {
+            if (f.complete) {
+                complete_frames++;
+                complete_reads += f.frame_rom_reads;
+            }
+        }
+        if (complete_frames > 0) {
+            double per_frame = double(complete_reads) / complete_frames;
+            printf("  Per complete frame: %.0f frame_mem reads, %.3f per "
+                   "display pixel\n\n",
+                   per_frame, per_frame / display_area);
+        } else {
+            std::cout << "\n";
+        }
+
+        // Per-frame rows (pixel budget per displayed frame)
+        if (!frames.empty()) {
+            std::cout << "Per-frame breakdown (rendered / display area, "
+                         "ROM reads):\n";
+            size_t shown = std::min<size_t>(frames.size(), 16);
+            for (size_t i = 0; i < shown; ++i) {
+                const FrameRow &f = frames[i];
+                printf("  frame %3zu: %8llu clocks, %8llu rendered (%.2f%%), "
+                       "%8llu / %8llu reads%s\n",
+                       i, (unsigned long long) f.clocks,
+                       (unsigned long long) f.rendered_clocks,
+                       100.0 * f.rendered_clocks / display_area,
+                       (unsigned long long) f.frame_rom_reads,
+                       (unsigned long long) f.palette_rom_reads,
+                       f.complete ? "" : " [partial]");
+            }
+            if (frames.size() > shown)
+                std::cout << "  ... " << (frames.size() - shown)
+                          << " more frames (see --profile-dump)\n";
+            std::cout << "\n";
+        }
+
+        // Scanline distribution: lit extent and busiest line
+        int first_line = -1, last_line = -1, busiest = 0;
+        for (int y = 0; y < V_RES; ++y) {
+            if (line_rendered[y] == 0)
+                continue;
+            if (first_line < 0)
+                first_line = y;
+            last_line = y;
+            if (line_rendered[y] > line_rendered[busiest])
+                busiest = y;
+        }
+        if (first_line >= 0) {
+            std::cout << "Scanline breakdown:\n";
+            std::cout << "  Lines with content: [" << first_line << ", "
+                      << last_line << "] (expected [0, "
+                      << NyancatModel<Mode>::SCALED_H - 1 << "])\n";
+            std::cout << "  Busiest line: " << busiest << " ("
+                      << line_rendered[busiest] << " rendered clocks)\n\n";
+        }
+
+        // Top colors by active clocks
+        std::vector<std::pair<uint64_t, int>> colors;
+        for (int c = 0; c < NUM_COLORS; ++c) {
+            if (color_hist[c] > 0)
+                colors.push_back({color_hist[c], c});
+        }
+        std::sort(colors.rbegin(), colors.rend());
+        uint64_t active_clocks = active_black_clocks + rendered_clocks;
+        if (!colors.empty() && active_clocks > 0) {
+            std::cout << "Color histogram (" << colors.size()
+                      << " distinct rrggbb values, top 8):\n";
+            for (size_t i = 0; i < colors.size() && i < 8; ++i) {
+                printf("  rrggbb=0x%02x: %10llu clocks (%.2f%% of active)\n",
+                       colors[i].second, (unsigned long long) colors[i].first,
+                       100.0 * colors[i].first / active_clocks);
+            }
+        }
 
         std::cout << "========================================\n";
     }
 
+    // Write per-frame, per-scanline and per-color tables
+    // Format selected by extension: .json → JSON, anything else → CSV
+    // (CSV holds three tables separated by blank lines, each with a header)
+    bool dump(const char *filename) const
+    {
+        FILE *fp = fopen(filename, "w");
+        if (!fp)
+            return false;
+
+        size_t len = strlen(filename);
+        bool json = len >= 5 && strcmp(filename + len - 5, ".json") == 0;
+
+        if (json) {
+            fprintf(fp,
+                    "{\n  \"mode\": \"%s\",\n  \"scale\": %d,\n"
+                    "  \"display_area\": %d,\n  \"total_clocks\": %llu,\n"
+                    "  \"blank_clocks\": %llu,\n"
+                    "  \"active_black_clocks\": %llu,\n"
+                    "  \"rendered_clocks\": %llu,\n"
+                    "  \"frame_rom_reads\": %llu,\n"
+                    "  \"palette_rom_reads\": %llu,\n  \"frames\": [",
+                    MODE_NAME, NyancatModel<Mode>::SCALE,
+                    NyancatModel<Mode>::SCALED_W * NyancatModel<Mode>::SCALED_H,
+                    (unsigned long long) total_clocks,
+                    (unsigned long long) blank_clocks,
+                    (unsigned long long) active_black_clocks,
+                    (unsigned long long) rendered_clocks,
+                    (unsigned long long) frame_rom_reads,
+                    (unsigned long long) palette_rom_reads);
+            for (size_t i = 0; i < frames.size(); ++i) {
+                const FrameRow &f = frames[i];
+                fprintf(fp,
+                        "%s\n    {\"frame\": %zu, \"complete\": %s, "
+                        "\"clocks\": %llu, \"blank\": %llu, "
+                        "\"active_black\": %llu, \"rendered\": %llu, "
+                        "\"frame_rom_reads\": %llu, "
+                        "\"palette_rom_reads\": %llu}",
+                        i ? "," : "", i, f.complete ? "true" : "false",
+                        (unsigned long long) f.clocks,
+                        (unsigned long long) f.blank_clocks,
+                        (unsigned long long) f.active_black_clocks,
+                        (unsigned long long) f.rendered_clocks,
+                        (unsigned long long) f.frame_rom_reads,
+                        (unsigned long long) f.palette_rom_reads);
+            }
+            fprintf(fp, "\n  ],\n  \"scanline_rendered\": [");
+            for (int y = 0; y < V_RES; ++y)
+                fprintf(fp, "%s%llu", y ? ", " : "",
+                        (unsigned long long) line_rendered[y]);
+            fprintf(fp, "],\n  \"color_histogram\": {");
+            bool first = true;
+            for (int c = 0; c < NUM_COLORS; ++c) {
+                if (color_hist[c] == 0)
+                    continue;
+                fprintf(fp, "%s\"0x%02x\": %llu", first ? "" : ", ", c,
+                        (unsigned long long) color_hist[c]);
+                first = false;
+            }
+            fprintf(fp, "}\n}\n");
+        } else {
+            fprintf(fp,
+                    "frame,complete,clocks,blank,active_black,rendered,"
+                    "frame_rom_reads,palette_rom_reads\n");
+            for (size_t i = 0; i < frames.size(); ++i) {
+                const FrameRow &f = frames[i];
+                fprintf(fp, "%zu,%d,%llu,%llu,%llu,%llu,%llu,%llu\n", i,
+                        f.complete, (unsigned long long) f.clocks,
+                        (unsigned long long) f.blank_clocks,
+                        (unsigned long long) f.active_black_clocks,
+                        (unsigned long long) f.rendered_clocks,
+                        (unsigned long long) f.frame_rom_reads,
+                        (unsigned long long) f.palette_rom_reads);
+            }
+            fprintf(fp, "\nline,rendered\n");
+            for (int y = 0; y < V_RES; ++y)
+                fprintf(fp, "%d,%llu\n", y,
+                        (unsigned long long) line_rendered[y]);
+            fprintf(fp, "\nrrggbb,clocks\n");
+            for (int c = 0; c < NUM_COLORS; ++c)
+                fprintf(fp, "0x%02x,%llu\n", c,
+                        (unsigned long long) color_hist[c]);
+        }
+
+        fclose(fp);
+        return true;
+    }
+
     uint64_t get_total_clocks() const { return total_clocks; }
     uint64_t get_rendered_clocks() const { return rendered_clocks; }
     double get_render_utilization() const
@@ -1007,185 +1347,1652 @@ public:
     }
 };
 
-// Standalone PNG encoder (no external dependencies)
-// Adapted from sysprog21/mado headless-ctl.c
-
-#if defined(__GNUC__) || defined(__clang__)
-#define BSWAP32(x) __builtin_bswap32(x)
-#else
-static inline uint32_t bswap32(uint32_t x)
+// Alignment Validator: Pixel pipeline skew and centering check per video mode
+//
+// Records, for every active line, the first and last active-video clock with
+// non-zero rrggbb, plus the vertical extent of the lit region, and checks
+// them against the geometry nyancat.v derives from the video mode:
+//   SCALE    = V_ACTIVE / 64        (7 at 480 lines, 9 at 600, 12 at 768)
+//   OFFSET_X = (H_ACTIVE - SCALED_W) / 2, OFFSET_Y = 0
+//
+// Columns are counted from the activevideo rising edge, so the lit span
+// starts at OFFSET_X + skew. Expected skew is 3 clocks: vga_sync_gen
+// registers x_px one clock after hc, then nyancat adds its 2-stage
+// frame ROM → palette ROM pipeline. A pipeline change that shifts the image
+// shows up here as a skew mismatch instead of a subtly offset PNG.
+//
+// Design principles:
+//   - Line checks on activevideo falling edge, frame check after V_RES lines
+//   - Assumes the animation's border pixels are non-black (background color)
+//   - Silent after first frame to avoid spam
+template <typename Mode>
+class AlignmentValidator
 {
-    return ((x & 0x000000ff) << 24) | ((x & 0x0000ff00) << 8) |
-           ((x & 0x00ff0000) >> 8) | ((x & 0xff000000) >> 24);
-}
-#define BSWAP32(x) bswap32(x)
-#endif
-
-// CRC32 table for PNG chunk verification
-static const uint32_t crc32_table[16] = {
-    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
-    0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
-    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
-};
+private:
+    USE_VIDEO_MODE(Mode);
+
+    static constexpr int SCALE = NyancatModel<Mode>::SCALE;
+    static constexpr int SCALED_W = NyancatModel<Mode>::SCALED_W;
+    static constexpr int SCALED_H = NyancatModel<Mode>::SCALED_H;
+    static constexpr int OFFSET_X = NyancatModel<Mode>::OFFSET_X;
+    static constexpr int OFFSET_Y = NyancatModel<Mode>::OFFSET_Y;
+    static constexpr int EXPECTED_SKEW = 3;  // x_px register + 2 ROM stages
+
+    // Per-line state
+    int col = 0;
+    int line_first = -1, line_last = -1;
+    bool prev_active = false, prev_vsync = true;
+
+    // Per-frame state (active_line counts from frame start)
+    bool frame_started = false;
+    int active_line = -1;
+    int lit_first_line = -1, lit_last_line = -1;
+    int frame_min_x = H_RES, frame_max_x = -1;
+
+    // Accumulated measurements
+    int min_skew = H_RES, max_skew = -H_RES;
+    int last_min_x = -1, last_max_x = -1;
+    int last_first_line = -1, last_last_line = -1;
+    int frames_checked = 0, lines_checked = 0;
+    int line_errors = 0, frame_errors = 0;
+    bool silent_mode = false;
 
-// Calculate CRC32 checksum
-static uint32_t crc32(uint32_t crc, const uint8_t *buf, size_t len)
-{
-    crc = ~crc;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= buf[i];
-        crc = (crc >> 4) ^ crc32_table[crc & 0x0f];
-        crc = (crc >> 4) ^ crc32_table[crc & 0x0f];
-    }
-    return ~crc;
-}
+    void check_line()
+    {
+        if (line_first < 0)
+            return;
 
-// Write PNG file with minimal dependencies
-static int save_png(const char *filename,
-                    const uint8_t *pixels,
-                    int width,
-                    int height)
-{
-    FILE *fp = fopen(filename, "wb");
-    if (!fp)
-        return -1;
+        lines_checked++;
+        if (lit_first_line < 0)
+            lit_first_line = active_line;
+        lit_last_line = active_line;
+        frame_min_x = std::min(frame_min_x, line_first);
+        frame_max_x = std::max(frame_max_x, line_last);
 
-    // PNG magic bytes
-    static const uint8_t png_sig[8] = {
-        0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A,
-    };
-    fwrite(png_sig, 1, 8, fp);
+        int skew = line_first - OFFSET_X;
+        int width = line_last - line_first + 1;
+        min_skew = std::min(min_skew, skew);
+        max_skew = std::max(max_skew, skew);
 
-// Helper macros for writing PNG chunks
-#define PUT_U32(u)           \
-    do {                     \
-        uint8_t b[4];        \
-        b[0] = (u) >> 24;    \
-        b[1] = (u) >> 16;    \
-        b[2] = (u) >> 8;     \
-        b[3] = (u);          \
-        fwrite(b, 1, 4, fp); \
-    } while (0)
+        if (skew != EXPECTED_SKEW || width != SCALED_W) {
+            if (!silent_mode) {
+                fprintf(stderr,
+                        "[ALIGNMENT ERROR] line %d: lit x=[%d, %d] "
+                        "(skew %d clocks, width %d), expected x=[%d, %d]\n",
+                        active_line, line_first, line_last, skew, width,
+                        OFFSET_X + EXPECTED_SKEW,
+                        OFFSET_X + EXPECTED_SKEW + SCALED_W - 1);
+            }
+            line_errors++;
+        }
+    }
 
-#define PUT_BYTES(buf, len) fwrite(buf, 1, len, fp)
+    void check_frame()
+    {
+        frames_checked++;
+        last_min_x = frame_min_x;
+        last_max_x = frame_max_x;
+        last_first_line = lit_first_line;
+        last_last_line = lit_last_line;
+
+        if (lit_first_line != OFFSET_Y ||
+            lit_last_line != OFFSET_Y + SCALED_H - 1) {
+            if (!silent_mode) {
+                fprintf(stderr,
+                        "[ALIGNMENT ERROR] lit lines [%d, %d], expected "
+                        "[%d, %d] (SCALE=%d)\n",
+                        lit_first_line, lit_last_line, OFFSET_Y,
+                        OFFSET_Y + SCALED_H - 1, SCALE);
+            }
+            frame_errors++;
+        }
 
-    // Write IHDR chunk
-    uint8_t ihdr[13];
-    uint32_t *p32 = (uint32_t *) ihdr;
-    p32[0] = BSWAP32(width);
-    p32[1] = BSWAP32(height);
-    ihdr[8] = 8;   // bit depth
-    ihdr[9] = 6;   // color type: RGBA
-    ihdr[10] = 0;  // compression
-    ihdr[11] = 0;  // filter
-    ihdr[12] = 0;  // interlace
+        silent_mode = true;  // Only report errors from first frame
+    }
 
-    PUT_U32(13);  // chunk length
-    PUT_BYTES("IHDR", 4);
-    PUT_BYTES(ihdr, 13);
-    uint32_t crc = crc32(0, (uint8_t *) "IHDR", 4);
-    crc = crc32(crc, ihdr, 13);
-    PUT_U32(crc);
+public:
+    AlignmentValidator() = default;
 
-    // Write IDAT chunk
-    size_t raw_size = height * (1 + width * 4);  // filter byte + RGBA per row
-    size_t max_deflate_size =
-        raw_size + ((raw_size + 7) >> 3) + ((raw_size + 63) >> 6) + 11;
+    void tick(bool vsync, bool activevideo, uint8_t rrggbb)
+    {
+        // Frame start: vsync falling edge
+        if (!vsync && prev_vsync) {
+            frame_started = true;
+            active_line = -1;
+            lit_first_line = lit_last_line = -1;
+            frame_min_x = H_RES;
+            frame_max_x = -1;
+        }
+        prev_vsync = vsync;
 
-    uint8_t *idat = (uint8_t *) malloc(max_deflate_size);
-    if (!idat) {
-        fclose(fp);
-        return -1;
-    }
+        // Line start: activevideo rising edge
+        if (activevideo && !prev_active) {
+            col = 0;
+            line_first = line_last = -1;
+            active_line++;
+        }
 
-    // Simple uncompressed DEFLATE block
-    size_t idat_size = 0;
-    idat[idat_size++] = 0x78;  // ZLIB header
-    idat[idat_size++] = 0x01;
+        if (activevideo) {
+            if (rrggbb != 0) {
+                if (line_first < 0)
+                    line_first = col;
+                line_last = col;
+            }
+            col++;
+        }
 
-    // Write uncompressed blocks
-    uint8_t *raw_data = (uint8_t *) malloc(raw_size);
-    if (!raw_data) {
-        free(idat);
-        fclose(fp);
-        return -1;
+        // Line end: activevideo falling edge
+        if (!activevideo && prev_active && frame_started) {
+            check_line();
+            if (active_line == V_RES - 1)
+                check_frame();
+        }
+        prev_active = activevideo;
     }
 
-    // Convert BGRA to RGBA with filter bytes
-    // Input format: BGRA (4 bytes per pixel)
-    // Output format: filter_byte + RGBA per scanline
-    size_t raw_pos = 0;
-    for (int y = 0; y < height; y++) {
-        raw_data[raw_pos++] = 0;  // filter type: none
-        for (int x = 0; x < width; x++) {
-            int idx = (y * width + x) * 4;
-            raw_data[raw_pos++] = pixels[idx + 2];  // R (from BGRA byte 2)
-            raw_data[raw_pos++] = pixels[idx + 1];  // G (from BGRA byte 1)
-            raw_data[raw_pos++] = pixels[idx + 0];  // B (from BGRA byte 0)
-            raw_data[raw_pos++] = pixels[idx + 3];  // A (from BGRA byte 3)
+    void report() const
+    {
+        std::cout << "Pixel Alignment Report (" << MODE_NAME << "):\n";
+        std::cout << "  Geometry: SCALE=" << SCALE << " SCALED=" << SCALED_W
+                  << "x" << SCALED_H << " OFFSET_X=" << OFFSET_X
+                  << " OFFSET_Y=" << OFFSET_Y << "\n";
+        std::cout << "  Expected lit region: x=[" << OFFSET_X + EXPECTED_SKEW
+                  << ", " << OFFSET_X + EXPECTED_SKEW + SCALED_W - 1
+                  << "] y=[" << OFFSET_Y << ", " << OFFSET_Y + SCALED_H - 1
+                  << "]\n";
+
+        if (frames_checked == 0) {
+            std::cout << "WARNING: Alignment validation incomplete (no full "
+                         "frame measured)\n";
+            return;
+        }
+
+        std::cout << "  Measured lit region: x=[" << last_min_x << ", "
+                  << last_max_x << "] y=[" << last_first_line << ", "
+                  << last_last_line << "]\n";
+        std::cout << "  Pipeline skew: " << min_skew;
+        if (max_skew != min_skew)
+            std::cout << ".." << max_skew;
+        std::cout << " clocks (expected " << EXPECTED_SKEW
+                  << ": x_px register + 2 ROM stages)\n";
+
+        if (line_errors == 0 && frame_errors == 0) {
+            std::cout << "PASS: Pixel alignment (" << frames_checked
+                      << " frames, " << lines_checked << " lit lines)\n";
+        } else {
+            std::cout << "FAIL: Pixel alignment\n";
+            if (line_errors > 0)
+                std::cout << "   Misaligned lines: " << line_errors << "\n";
+            if (frame_errors > 0)
+                std::cout << "   Vertical extent errors: " << frame_errors
+                          << "\n";
         }
     }
 
-    // Write as uncompressed DEFLATE blocks
-    size_t pos = 0;
-    while (pos < raw_size) {
-        size_t chunk = raw_size - pos;
-        if (chunk > 65535)
-            chunk = 65535;
+    bool has_errors() const { return line_errors > 0 || frame_errors > 0; }
 
-        // final block flag
-        idat[idat_size++] = (pos + chunk >= raw_size) ? 1 : 0;
-        idat[idat_size++] = chunk & 0xff;
-        idat[idat_size++] = (chunk >> 8) & 0xff;
-        idat[idat_size++] = ~chunk & 0xff;
-        idat[idat_size++] = (~chunk >> 8) & 0xff;
+    int get_total_errors() const { return line_errors + frame_errors; }
 
-        memcpy(idat + idat_size, raw_data + pos, chunk);
-        idat_size += chunk;
-        pos += chunk;
-    }
+    bool is_complete() const { return frames_checked > 0; }
+};
 
-    // ADLER32 checksum (RFC 1950)
-    uint32_t s1 = 1, s2 = 0;
-    for (size_t i = 0; i < raw_size; i++) {
-        s1 = (s1 + raw_data[i]) % 65521;
-        s2 = (s2 + s1) % 65521;
-    }
-    uint32_t adler = (s2 << 16) | s1;
-    idat[idat_size++] = (adler >> 24) & 0xff;
-    idat[idat_size++] = (adler >> 16) & 0xff;
-    idat[idat_size++] = (adler >> 8) & 0xff;
-    idat[idat_size++] = adler & 0xff;
+// Lockstep Checker: Co-simulate the C++ reference model against the RTL
+//
+// Steps NyancatModel once per RTL clock and compares every top-level output.
+// The first divergence is reported with the clock number, both output sets
+// and the complete model state; later mismatches are only counted.
+//
+// Design principles:
+//   - Model sees the same reset_n the RTL sampled on this edge
+//   - Compare after the rising edge, same sampling point as other observers
+//   - Report once (first divergence carries the useful context)
+template <typename Mode>
+class LockstepChecker
+{
+private:
+    USE_VIDEO_MODE(Mode);
 
-    PUT_U32(idat_size);
-    PUT_BYTES("IDAT", 4);
-    PUT_BYTES(idat, idat_size);
-    crc = crc32(0, (uint8_t *) "IDAT", 4);
-    crc = crc32(crc, idat, idat_size);
-    PUT_U32(crc);
+    NyancatModel<Mode> model;
+    uint64_t clocks = 0;
+    uint64_t mismatches = 0;
+    bool loaded = false;
 
-    // Write IEND chunk
-    PUT_U32(0);
-    PUT_BYTES("IEND", 4);
-    PUT_U32(crc32(0, (uint8_t *) "IEND", 4));
+public:
+    LockstepChecker() { loaded = model.load(); }
 
-#undef PUT_U32
-#undef PUT_BYTES
+    bool is_loaded() const { return loaded; }
 
-    free(raw_data);
-    free(idat);
-    fclose(fp);
-    return 0;
-}
+    // Advance model by one pixel clock and compare it with the RTL outputs;
+    // rrggbb is the RTL color of that pixel (one lane of top->rrggbb)
+    template <typename Top>
+    void tick(const Top *top, uint8_t rrggbb)
+    {
+        model.reset_n = top->reset_n;
+        model.clk = 0;
+        model.eval();
+        model.clk = 1;
+        model.eval();
+
+        bool match = model.hsync == top->hsync && model.vsync == top->vsync &&
+                     model.activevideo == top->activevideo &&
+                     model.rrggbb == rrggbb;
+        if (!match) {
+            if (mismatches == 0) {
+                fprintf(stderr,
+                        "[LOCKSTEP] First divergence at clock %llu\n"
+                        "  RTL:   hsync=%d vsync=%d activevideo=%d "
+                        "rrggbb=0x%02x\n"
+                        "  Model state:\n",
+                        (unsigned long long) clocks, top->hsync, top->vsync,
+                        top->activevideo, rrggbb);
+                model.dump_state(stderr);
+            }
+            mismatches++;
+        }
+        clocks++;
+    }
+
+    void report() const
+    {
+        if (mismatches == 0) {
+            std::cout << "PASS: Lockstep co-simulation (" << clocks
+                      << " clocks, model matches RTL)\n";
+        } else {
+            std::cout << "FAIL: Lockstep co-simulation\n";
+            std::cout << "   Mismatched clocks: " << mismatches << "/"
+                      << clocks << "\n";
+        }
+    }
+
+    bool has_errors() const { return mismatches > 0; }
+
+    uint64_t get_total_errors() const { return mismatches; }
+};
+
+// Streaming Timing Analyzer: analyze-vcd.py without the VCD file
+//
+// Reproduces the scripts/analyze-vcd.py report from the live signals, so a
+// full frame (or 100 frames) can be verified without writing and re-parsing
+// a multi-hundred-MB trace. Time is counted in trace dump units (2 per
+// clock, one per edge) so every number is directly comparable with the
+// script's output for a --trace of the same run.
+//
+// Design principles:
+//   - Single pass, constant memory: running sums and min/max instead of
+//     per-edge lists
+//   - Same section semantics as the script: falling-edge sync counts and
+//     periods, closed activevideo high intervals, pulses shorter than
+//     GLITCH_THRESHOLD units, 1% period consistency check
+//   - Same report layout and exit status (violations fail the run)
+class StreamingTimingAnalyzer
+{
+public:
+    static constexpr uint64_t GLITCH_THRESHOLD = 10;  // Time units
+    static constexpr double MAX_VARIANCE = 0.01;     // 1% period variance
+
+    // Observe one clock after the rising edge
+    void tick(bool hsync, bool vsync, bool activevideo)
+    {
+        // Outputs change on the rising edge: second dump of this clock
+        uint64_t t = clocks * 2 + 1;
+        hsync_sig.sample(hsync, t, glitches, "hsync");
+        vsync_sig.sample(vsync, t, glitches, "vsync");
+        if (active_sig.sample(activevideo, t, glitches, "activevideo") &&
+            !activevideo)
+            activevideo_cycles += t - active_sig.prev_change;
+        clocks++;
+    }
+
+    // Print script-style sections and write the report file (if any)
+    bool report(const char *output_file)
+    {
+        std::cout << "\n=== Analyzing Sync Signals ===\n";
+        print_sync("Hsync", hsync_sig);
+        print_sync("Vsync", vsync_sig);
+
+        std::cout << "\n=== Analyzing Active Video ===\n";
+        std::cout << "  Active video cycles: " << activevideo_cycles << "\n";
+
+        std::cout << "\n=== Detecting Glitches ===\n";
+        if (glitches.count > 0) {
+            std::cout << "  Found " << glitches.count
+                      << " potential glitches\n";
+            for (const std::string &g : glitches.first)
+                std::cout << "    " << g << "\n";
+        } else {
+            std::cout << "  No glitches detected\n";
+        }
+
+        std::cout << "\n=== VGA Timing Validation ===\n";
+        validate("Hsync", hsync_sig);
+        validate("Vsync", vsync_sig);
+
+        std::string text = build_report();
+        std::cout << "\n" << text << "\n";
+        bool ok = true;
+        if (output_file) {
+            FILE *fp = fopen(output_file, "w");
+            if (fp) {
+                fputs(text.c_str(), fp);
+                fclose(fp);
+                std::cout << "\nReport saved to: " << output_file << "\n";
+            } else {
+                fprintf(stderr, "Error: cannot write %s\n", output_file);
+                ok = false;
+            }
+        }
+
+        if (violations.empty())
+            std::cout << "PASS: Streaming timing analysis (" << clocks
+                      << " clocks, no timing violations)\n";
+        else
+            std::cout << "FAIL: Streaming timing analysis ("
+                      << violations.size() << " timing violations)\n";
+        return ok;
+    }
+
+    bool has_errors() const { return !violations.empty(); }
+
+private:
+    // Up to 5 glitch descriptions kept for the console (as the script)
+    struct GlitchLog {
+        uint64_t count = 0;
+        std::vector<std::string> first;
+    };
+
+    // Running edge state for one 1-bit signal
+    struct SignalState {
+        bool seen = false, value = false;
+        uint64_t last_change = 0, prev_change = 0;
+        uint64_t last_fall = 0, falls = 0;
+        uint64_t periods = 0, period_sum = 0;
+        uint64_t period_min = UINT64_MAX, period_max = 0;
+
+        // Returns true on a value change (prev_change holds the time of
+        // the change before it)
+        bool sample(bool v, uint64_t t, GlitchLog &log, const char *name)
+        {
+            if (!seen) {
+                seen = true;
+                value = v;
+                last_change = t;
+                return false;
+            }
+            if (v == value)
+                return false;
+
+            if (t - last_change < GLITCH_THRESHOLD) {
+                if (log.first.size() < 5)
+                    log.first.push_back(std::string(name) + " @ " +
+                                        std::to_string(last_change) + ": " +
+                                        std::to_string(t - last_change) +
+                                        " units");
+                log.count++;
+            }
+            if (value && !v) {
+                if (falls > 0) {
+                    uint64_t p = t - last_fall;
+                    periods++;
+                    period_sum += p;
+                    period_min = std::min(period_min, p);
+                    period_max = std::max(period_max, p);
+                }
+                falls++;
+                last_fall = t;
+            }
+            prev_change = last_change;
+            last_change = t;
+            value = v;
+            return true;
+        }
+
+        double average() const
+        {
+            return periods ? double(period_sum) / periods : 0.0;
+        }
+    };
+
+    uint64_t clocks = 0;
+    SignalState hsync_sig, vsync_sig, active_sig;
+    uint64_t activevideo_cycles = 0;
+    GlitchLog glitches;
+    std::vector<std::string> violations;
+
+    void print_sync(const char *name, const SignalState &s) const
+    {
+        if (!s.periods)
+            return;
+        printf("  %s pulses: %llu\n", name, (unsigned long long) s.falls);
+        printf("  Avg %c%s period: %.0f time units\n", tolower(name[0]),
+               name + 1, s.average());
+    }
+
+    void validate(const char *name, const SignalState &s)
+    {
+        if (s.periods < 2)
+            return;
+        double avg = s.average();
+        double max_dev = std::max(s.period_max - avg, avg - s.period_min);
+        double variance = avg > 0 ? max_dev / avg : 0;
+        char line[160];
+        if (variance > MAX_VARIANCE) {
+            snprintf(line, sizeof(line),
+                     "%s period inconsistent: %.1f%% variance (max %.1f%%)",
+                     name, variance * 100, MAX_VARIANCE * 100);
+            violations.push_back(line);
+            std::cout << "  ✗ " << line << "\n";
+        } else {
+            printf("  ✓ %s period consistent: %.0f time units (variance "
+                   "%.2f%%)\n",
+                   name, avg, variance * 100);
+        }
+    }
+
+    std::string build_report() const
+    {
+        std::string sep(60, '=');
+        char buf[160];
+        std::string r = sep + "\nVGA Nyancat VCD Waveform Analysis Report\n" +
+                        sep + "\n";
+        r += "\nVCD File: (none, streamed from simulation)\n";
+        r += "Timescale: 2 time units per clock\n";
+        snprintf(buf, sizeof(buf),
+                 "Simulation duration: %llu time units\n",
+                 (unsigned long long) (clocks * 2));
+        r += buf;
+        r += "Signals analyzed: 3\n";
+
+        r += "\n--- Sync Signal Statistics ---\n";
+        snprintf(buf, sizeof(buf), "Hsync pulses: %llu\nVsync pulses: %llu\n",
+                 (unsigned long long) hsync_sig.falls,
+                 (unsigned long long) vsync_sig.falls);
+        r += buf;
+        if (hsync_sig.periods) {
+            snprintf(buf, sizeof(buf), "Avg hsync period: %.2f time units\n",
+                     hsync_sig.average());
+            r += buf;
+        }
+        if (vsync_sig.periods) {
+            snprintf(buf, sizeof(buf), "Avg vsync period: %.2f time units\n",
+                     vsync_sig.average());
+            r += buf;
+        }
+
+        snprintf(buf, sizeof(buf), "\nActive video cycles: %llu\n",
+                 (unsigned long long) activevideo_cycles);
+        r += buf;
+
+        r += "\n--- Issues Detected ---\n";
+        snprintf(buf, sizeof(buf), "Glitches: %llu\nTiming violations: %zu\n",
+                 (unsigned long long) glitches.count, violations.size());
+        r += buf;
+        if (!violations.empty()) {
+            r += "\nTiming Violations:\n";
+            for (const std::string &v : violations)
+                r += "  - " + v + "\n";
+        }
+        r += "\n" + sep;
+        return r;
+    }
+};
+
+// Host Profiler: Where does host (wall-clock) time go?
+//
+// RenderProfiler describes how the RTL spends its clocks; this measures the
+// cost of simulating them. Phases:
+//   - Verilator eval() (both edges) and trace dumps
+//   - Observer ticks (validators, profilers, lockstep)
+//   - Framebuffer writes (including host-side position tracking)
+//   - SDL texture upload + present, PNG encode (incl. CRC/Adler), events
+//
+// Low-overhead measurement:
+//   - Each simulate_frame() chunk is timed once as a whole
+//   - Inside the clock loop only 1 in SAMPLE_INTERVAL clocks is split into
+//     phases; the chunk total is then apportioned by the sampled ratios
+//   - Rare but expensive per-frame work (ChangeTracker) is timed directly
+//     and excluded from the apportioned loop time
+//   - Timestamps use rdtsc on x86 (calibrated against steady_clock over
+//     the run), steady_clock elsewhere
+class HostProfiler
+{
+public:
+    enum Phase {
+        EVAL,
+        TRACE,
+        OBSERVERS,
+        FRAMEBUFFER,
+        TEXTURE,
+        PNG,
+        EVENTS,
+        NUM_PHASES
+    };
+
+    static constexpr uint32_t SAMPLE_INTERVAL = 256;  // Power of two
+
+    static inline uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    HostProfiler()
+    {
+        start_ticks = now();
+        start_time = std::chrono::steady_clock::now();
+    }
+
+    // Should clock i of the current chunk be split into phases?
+    static bool sampled(uint64_t i) { return (i & (SAMPLE_INTERVAL - 1)) == 0; }
+
+    // Attribute time since mark to a sampled phase and advance mark
+    void lap(Phase phase, uint64_t &mark)
+    {
+        uint64_t t = now();
+        sampled_ticks[phase] += t - mark;
+        mark = t;
+    }
+
+    // Whole clock-loop chunk (apportioned using sampled ratios)
+    void add_chunk(uint64_t ticks, uint64_t clocks)
+    {
+        loop_ticks += ticks;
+        sim_clocks += clocks;
+    }
+
+    // Directly timed work; in_loop marks time already inside a chunk
+    void add_direct(Phase phase, uint64_t ticks, bool in_loop = false)
+    {
+        direct_ticks[phase] += ticks;
+        if (in_loop)
+            loop_direct_ticks += ticks;
+    }
+
+    void report() const
+    {
+        uint64_t wall_ticks = now() - start_ticks;
+        double wall_ns = std::chrono::duration<double, std::nano>(
+                             std::chrono::steady_clock::now() - start_time)
+                             .count();
+        double ns_per_tick = wall_ticks ? wall_ns / wall_ticks : 0.0;
+
+        // Apportion the clock loop by sampled phase ratios
+        uint64_t sampled_sum = 0;
+        for (int p = 0; p < NUM_PHASES; ++p)
+            sampled_sum += sampled_ticks[p];
+        double apportioned =
+            loop_ticks > loop_direct_ticks ? loop_ticks - loop_direct_ticks : 0;
+
+        double phase_ns[NUM_PHASES];
+        double tracked_ns = 0;
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            double ticks = direct_ticks[p];
+            if (sampled_sum > 0)
+                ticks += apportioned * sampled_ticks[p] / sampled_sum;
+            phase_ns[p] = ticks * ns_per_tick;
+            tracked_ns += phase_ns[p];
+        }
+
+        static const char *names[NUM_PHASES] = {
+            "Verilator eval", "Trace dump",          "Observer ticks",
+            "Framebuffer",    "SDL texture/present", "PNG encode (CRC)",
+            "Event polling",
+        };
+
+        std::cout << "\n========================================\n";
+        std::cout << "Host Time Profile\n";
+        std::cout << "========================================\n\n";
+        printf("Wall time: %.1f ms, simulated clocks: %llu", wall_ns / 1e6,
+               (unsigned long long) sim_clocks);
+        if (sim_clocks > 0)
+            printf(" (%.1f ns/clock, %.2f Mclk/s)", wall_ns / sim_clocks,
+                   sim_clocks / (wall_ns / 1e3));
+        printf("\nTimer: %s, 1/%u clocks sampled\n\n",
+#if defined(__x86_64__) || defined(__i386__)
+               "rdtsc",
+#else
+               "steady_clock",
+#endif
+               SAMPLE_INTERVAL);
+
+        printf("  %-20s %12s %8s %10s\n", "Phase", "Total ms", "%",
+               "ns/clock");
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            printf("  %-20s %12.2f %7.2f%% %10.2f\n", names[p],
+                   phase_ns[p] / 1e6,
+                   wall_ns > 0 ? 100.0 * phase_ns[p] / wall_ns : 0.0,
+                   sim_clocks ? phase_ns[p] / sim_clocks : 0.0);
+        }
+        double other_ns = wall_ns > tracked_ns ? wall_ns - tracked_ns : 0;
+        printf("  %-20s %12.2f %7.2f%% %10.2f\n", "Other (untracked)",
+               other_ns / 1e6, wall_ns > 0 ? 100.0 * other_ns / wall_ns : 0.0,
+               sim_clocks ? other_ns / sim_clocks : 0.0);
+        std::cout << "========================================\n";
+    }
+
+private:
+    uint64_t start_ticks = 0;
+    std::chrono::steady_clock::time_point start_time;
+    uint64_t sampled_ticks[NUM_PHASES] = {};
+    uint64_t direct_ticks[NUM_PHASES] = {};
+    uint64_t loop_ticks = 0, loop_direct_ticks = 0;
+    uint64_t sim_clocks = 0;
+};
+
+// Scoped direct measurement of one host phase (no-op without a profiler)
+class HostPhaseTimer
+{
+public:
+    HostPhaseTimer(HostProfiler *host, HostProfiler::Phase phase)
+        : host(host), phase(phase), start(host ? HostProfiler::now() : 0)
+    {
+    }
+    uint64_t started() const { return start; }
+    ~HostPhaseTimer()
+    {
+        if (host)
+            host->add_direct(phase, HostProfiler::now() - start);
+    }
+
+private:
+    HostProfiler *host;
+    HostProfiler::Phase phase;
+    uint64_t start;
+};
+
+// Internal RTL state captured by triggered traces (and ROM read enables for
+// the render profiler). hc/vc (vga_sync_gen), frame_index and the ROM
+// enables (nyancat) are marked verilator public_flat_rd in the RTL so they
+// survive optimization and can be read through rootp in every build.
+// The ROM enables have one bit per pixel lane. shown_frame is the frame the
+// picture is drawn from: frame_index, or show_frame in delta builds.
+struct ProbeState {
+    uint32_t hc, vc;
+    uint8_t frame_index, shown_frame;
+    uint8_t frame_rom_en, palette_rom_en;
+};
+
+template <typename Top>
+inline ProbeState probe_internals(const Top *top)
+{
+    const auto *r = top->rootp;
+    return {r->vga_nyancat__DOT__vga_sync__DOT__hc,
+            r->vga_nyancat__DOT__vga_sync__DOT__vc,
+            r->vga_nyancat__DOT__nyan__DOT__frame_index,
+#if NYANCAT_FRAME_DELTA
+            r->vga_nyancat__DOT__nyan__DOT__show_frame,
+#else
+            r->vga_nyancat__DOT__nyan__DOT__frame_index,
+#endif
+            (uint8_t) r->vga_nyancat__DOT__nyan__DOT__frame_rom_en,
+            (uint8_t) r->vga_nyancat__DOT__nyan__DOT__palette_rom_en};
+}
+
+template <typename Mode>
+inline ProbeState probe_internals(const NyancatModel<Mode> *model)
+{
+    // The model has no line buffer: reads follow the display area, observed
+    // one stage late (in_display_q is the enable of the previous clock)
+    const typename NyancatModel<Mode>::State &s = model->get_state();
+    return {s.hc,
+            s.vc,
+            (uint8_t) s.frame_index,
+            (uint8_t) (NYANCAT_FRAME_DELTA ? s.show_frame : s.frame_index),
+            (uint8_t) s.in_display_q,
+            (uint8_t) s.in_display_q2};
+}
+
+// Triggered Trace: Capture a waveform window around a rare event
+//
+// Full tracing from reset is useless for glitches that show up after hours
+// of soak. This keeps the last M clocks of the top-level ports and key
+// internals (hc, vc, frame_index) in a ring buffer; when the trigger fires,
+// the ring plus N post-trigger clocks are written to a VCD (or FST) file.
+//
+// Trigger conditions:
+//   - frame=K  first clock of the K-th vsync pulse (K >= 1)
+//   - vsync    first vsync pulse (same as frame=1)
+//   - error    first clock at which any enabled validator/checker has errors
+//   - X,Y      first clock with activevideo and RTL x_px,y_px == X,Y
+//
+// Design principles:
+//   - One-shot: the first trigger wins, later events are ignored
+//   - Fixed-size samples in a preallocated ring (no allocation per clock)
+//   - Independent of Verilator tracing, so it also works in the fast build
+//   - Waveform uses the RTL signal names and scopes so analyze-vcd.py and
+//     saved viewer layouts keep working; time advances 2 units per clock
+//     like the --trace dumps
+template <typename Mode>
+class TriggeredTrace
+{
+    USE_VIDEO_MODE(Mode);
+
+public:
+    enum Kind { TRIGGER_FRAME, TRIGGER_ERROR, TRIGGER_COORD };
+
+    TriggeredTrace(const char *filename, bool fst, Kind kind, int arg_x,
+                   int arg_y, int pre, int post)
+        : filename(filename), fst(fst), kind(kind), arg_x(arg_x),
+          arg_y(arg_y), post(post), ring(pre > 0 ? pre : 1)
+    {
+    }
+
+    // Parse "frame=K", "vsync", "error" or "X,Y"; returns nullptr on error
+    static TriggeredTrace *create(const char *spec, const char *filename,
+                                  bool fst, int pre, int post)
+    {
+        int a = 0, b = 0;
+        char tail;
+        if (strcmp(spec, "vsync") == 0)
+            return new TriggeredTrace(filename, fst, TRIGGER_FRAME, 1, 0, pre,
+                                      post);
+        if (strcmp(spec, "error") == 0)
+            return new TriggeredTrace(filename, fst, TRIGGER_ERROR, 0, 0, pre,
+                                      post);
+        if (sscanf(spec, "frame=%d%c", &a, &tail) == 1 && a >= 1)
+            return new TriggeredTrace(filename, fst, TRIGGER_FRAME, a, 0, pre,
+                                      post);
+        if (sscanf(spec, "%d,%d%c", &a, &b, &tail) == 2 && a >= 0 &&
+            a < H_RES && b >= 0 && b < V_RES)
+            return new TriggeredTrace(filename, fst, TRIGGER_COORD, a, b, pre,
+                                      post);
+        fprintf(stderr,
+                "Error: invalid --trace-trigger '%s' (expected frame=K, "
+                "vsync, error or X,Y within %dx%d)\n",
+                spec, H_RES, V_RES);
+        return nullptr;
+    }
+
+    // Only evaluate validator state when it can fire the trigger
+    bool wants_errors() const { return kind == TRIGGER_ERROR && !fired; }
+
+    // Record one clock (after the rising edge); error is the combined
+    // has_errors() of the enabled checkers (only computed for 'error')
+    template <typename Top>
+    void tick(const Top *top, bool error = false)
+    {
+        if (done)
+            return;
+
+        ProbeState p = probe_internals(top);
+        Sample &s = ring[head];
+        s.clock = clock;
+        s.reset_n = top->reset_n;
+        s.hsync = top->hsync;
+        s.vsync = top->vsync;
+        s.activevideo = top->activevideo;
+        s.rrggbb = top->rrggbb;
+        s.hc = p.hc;
+        s.vc = p.vc;
+        s.frame_index = p.frame_index;
+        head = (head + 1) % ring.size();
+        if (count < ring.size())
+            count++;
+
+        if (fired) {
+            if (++post_count >= post)
+                write();
+        } else if (check(s, error)) {
+            fired = true;
+            trigger_clock = clock;
+            // The ring must hold pre-trigger history plus the post window
+            grow_for_post();
+            if (post == 0)
+                write();
+        }
+        prev_vsync = s.vsync;
+        clock++;
+    }
+
+    // Flush a capture whose post-trigger window was cut short by exit
+    void finish()
+    {
+        if (fired && !done)
+            write();
+    }
+
+    void report() const
+    {
+        std::cout << "\n========================================\n";
+        std::cout << "Triggered Trace\n";
+        std::cout << "========================================\n\n";
+        std::cout << "Trigger: " << describe() << "\n";
+        if (!fired) {
+            std::cout << "Trigger never fired (" << clock
+                      << " clocks observed, nothing written)\n";
+        } else {
+            std::cout << "Fired at clock " << trigger_clock << "\n";
+            std::cout << "Wrote " << written << " clocks (" << written_pre
+                      << " pre-trigger, " << written - written_pre
+                      << " post-trigger) to " << filename << "\n";
+            if (write_failed)
+                std::cout << "   Error: could not write " << filename << "\n";
+        }
+        std::cout << "========================================\n";
+    }
+
+private:
+    struct Sample {
+        uint64_t clock;
+        uint32_t hc, vc;
+        uint8_t reset_n, hsync, vsync, activevideo, frame_index;
+        uint16_t rrggbb;  // All pixel lanes of the clock
+    };
+
+    const char *filename;
+    bool fst;
+    Kind kind;
+    int arg_x, arg_y;
+    uint64_t post;
+
+    std::vector<Sample> ring;
+    size_t head = 0, count = 0;
+    size_t pre_capacity = 0;
+
+    uint64_t clock = 0;
+    uint64_t trigger_clock = 0;
+    uint64_t post_count = 0;
+    int vsync_pulses = 0;
+    bool prev_vsync = true;
+    bool fired = false, done = false, write_failed = false;
+    uint64_t written = 0, written_pre = 0;
+
+    bool check(const Sample &s, bool error)
+    {
+        switch (kind) {
+        case TRIGGER_FRAME:
+            if (prev_vsync && !s.vsync)
+                return ++vsync_pulses == arg_x;
+            return false;
+        case TRIGGER_ERROR:
+            return error;
+        case TRIGGER_COORD:
+            // With two pixels per clock hc only takes even values; the
+            // clock carrying X (in either lane) fires
+            return s.activevideo &&
+                   s.hc / PIXELS_PER_CLOCK ==
+                       (uint32_t) (H_BLANKING + arg_x) / PIXELS_PER_CLOCK &&
+                   s.vc == (uint32_t) (V_BLANKING + arg_y);
+        }
+        return false;
+    }
+
+    std::string describe() const
+    {
+        char buf[64];
+        switch (kind) {
+        case TRIGGER_FRAME:
+            snprintf(buf, sizeof(buf), "vsync pulse %d", arg_x);
+            break;
+        case TRIGGER_ERROR:
+            snprintf(buf, sizeof(buf), "first validator error");
+            break;
+        case TRIGGER_COORD:
+            snprintf(buf, sizeof(buf), "pixel (%d, %d)", arg_x, arg_y);
+            break;
+        }
+        return buf;
+    }
+
+    // Re-linearize the ring with room for the post-trigger clocks so none
+    // of the pre-trigger history is overwritten
+    void grow_for_post()
+    {
+        std::vector<Sample> linear;
+        linear.reserve(count + post);
+        for (size_t i = 0; i < count; ++i)
+            linear.push_back(ring[(head + ring.size() - count + i) %
+                                  ring.size()]);
+        pre_capacity = count;
+        linear.resize(count + post);
+        ring.swap(linear);
+        head = count % ring.size();
+    }
+
+    // Oldest-first access to the captured window
+    const Sample &at(size_t i) const
+    {
+        return ring[(head + ring.size() - count + i) % ring.size()];
+    }
+
+    static void to_bits(uint32_t value, int width, char *out)
+    {
+        for (int b = 0; b < width; ++b)
+            out[b] = (value >> (width - 1 - b)) & 1 ? '1' : '0';
+        out[width] = '\0';
+    }
+
+    // Captured signals (clk is implicit): scope, name, width
+    struct Signal {
+        int scope;  // 0: vga_nyancat, 1: vga_sync, 2: nyan
+        const char *name;
+        int width;
+    };
+    static constexpr int NUM_SIGNALS = 8;
+
+    static const Signal *signals()
+    {
+        static const Signal list[NUM_SIGNALS] = {
+            {0, "reset_n", 1},     {0, "hsync", 1},
+            {0, "vsync", 1},       {0, "activevideo", 1},
+            {0, "rrggbb", 6 * PIXELS_PER_CLOCK},
+            {1, "hc", clog2(H_TOTAL)},
+            {1, "vc", clog2(V_TOTAL)}, {2, "frame_index", 4},
+        };
+        return list;
+    }
+
+    static uint32_t value(const Sample &s, int i)
+    {
+        switch (i) {
+        case 0:
+            return s.reset_n;
+        case 1:
+            return s.hsync;
+        case 2:
+            return s.vsync;
+        case 3:
+            return s.activevideo;
+        case 4:
+            return s.rrggbb;
+        case 5:
+            return s.hc;
+        case 6:
+            return s.vc;
+        default:
+            return s.frame_index;
+        }
+    }
+
+    void write()
+    {
+        done = true;
+        written = count;
+        written_pre = pre_capacity;
+        bool ok = fst ? write_fst() : write_vcd();
+        write_failed = !ok;
+        if (!ok)
+            fprintf(stderr, "[TRIGGER] Cannot write %s\n", filename);
+        ring.clear();
+        ring.shrink_to_fit();
+        count = 0;
+    }
+
+    bool write_vcd() const
+    {
+        FILE *fp = fopen(filename, "w");
+        if (!fp)
+            return false;
+
+        const Signal *sig = signals();
+        static const char *scopes[] = {nullptr, "vga_sync", "nyan"};
+        fprintf(fp, "$version VGA Nyancat triggered trace $end\n");
+        fprintf(fp, "$timescale 1ps $end\n");
+        fprintf(fp, "$scope module vga_nyancat $end\n");
+        fprintf(fp, "$var wire 1 ! clk $end\n");
+        int open_scope = 0;
+        for (int i = 0; i < NUM_SIGNALS; ++i) {
+            if (sig[i].scope != open_scope) {
+                if (open_scope)
+                    fprintf(fp, "$upscope $end\n");
+                fprintf(fp, "$scope module %s $end\n", scopes[sig[i].scope]);
+                open_scope = sig[i].scope;
+            }
+            if (sig[i].width == 1)
+                fprintf(fp, "$var wire 1 %c %s $end\n", (char) ('A' + i),
+                        sig[i].name);
+            else
+                fprintf(fp, "$var wire %d %c %s [%d:0] $end\n", sig[i].width,
+                        (char) ('A' + i), sig[i].name, sig[i].width - 1);
+        }
+        if (open_scope)
+            fprintf(fp, "$upscope $end\n");
+        fprintf(fp, "$upscope $end\n$enddefinitions $end\n");
+
+        uint32_t last[NUM_SIGNALS];
+        std::fill(last, last + NUM_SIGNALS, ~0u);
+        char bits[33];
+        for (size_t n = 0; n < count; ++n) {
+            const Sample &s = at(n);
+            fprintf(fp, "#%llu\n1!\n", (unsigned long long) (s.clock * 2));
+            for (int i = 0; i < NUM_SIGNALS; ++i) {
+                uint32_t v = value(s, i);
+                if (v == last[i])
+                    continue;
+                last[i] = v;
+                if (sig[i].width == 1) {
+                    fprintf(fp, "%u%c\n", v, (char) ('A' + i));
+                } else {
+                    to_bits(v, sig[i].width, bits);
+                    fprintf(fp, "b%s %c\n", bits, (char) ('A' + i));
+                }
+            }
+            fprintf(fp, "#%llu\n0!\n", (unsigned long long) (s.clock * 2 + 1));
+        }
+        bool ok = !ferror(fp);
+        fclose(fp);
+        return ok;
+    }
+
+    bool write_fst() const
+    {
+#if VM_TRACE_FST
+        void *ctx = fstWriterCreate(filename, 1);
+        if (!ctx)
+            return false;
+
+        const Signal *sig = signals();
+        static const char *scopes[] = {nullptr, "vga_sync", "nyan"};
+        fstWriterSetTimescaleFromString(ctx, "1ps");
+        fstWriterSetScope(ctx, FST_ST_VCD_MODULE, "vga_nyancat", nullptr);
+        fstHandle clk = fstWriterCreateVar(ctx, FST_VT_VCD_WIRE,
+                                           FST_VD_IMPLICIT, 1, "clk", 0);
+        fstHandle handles[NUM_SIGNALS];
+        int open_scope = 0;
+        for (int i = 0; i < NUM_SIGNALS; ++i) {
+            if (sig[i].scope != open_scope) {
+                if (open_scope)
+                    fstWriterSetUpscope(ctx);
+                fstWriterSetScope(ctx, FST_ST_VCD_MODULE,
+                                  scopes[sig[i].scope], nullptr);
+                open_scope = sig[i].scope;
+            }
+            handles[i] = fstWriterCreateVar(ctx, FST_VT_VCD_WIRE,
+                                            FST_VD_IMPLICIT, sig[i].width,
+                                            sig[i].name, 0);
+        }
+        if (open_scope)
+            fstWriterSetUpscope(ctx);
+        fstWriterSetUpscope(ctx);
+
+        uint32_t last[NUM_SIGNALS];
+        std::fill(last, last + NUM_SIGNALS, ~0u);
+        char bits[33];
+        for (size_t n = 0; n < count; ++n) {
+            const Sample &s = at(n);
+            fstWriterEmitTimeChange(ctx, s.clock * 2);
+            fstWriterEmitValueChange(ctx, clk, "1");
+            for (int i = 0; i < NUM_SIGNALS; ++i) {
+                uint32_t v = value(s, i);
+                if (v == last[i])
+                    continue;
+                last[i] = v;
+                to_bits(v, sig[i].width, bits);
+                fstWriterEmitValueChange(ctx, handles[i], bits);
+            }
+            fstWriterEmitTimeChange(ctx, s.clock * 2 + 1);
+            fstWriterEmitValueChange(ctx, clk, "0");
+        }
+        fstWriterClose(ctx);
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+// Standalone PNG encoder (no external dependencies)
+// Adapted from sysprog21/mado headless-ctl.c
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BSWAP32(x) __builtin_bswap32(x)
+#else
+static inline uint32_t bswap32(uint32_t x)
+{
+    return ((x & 0x000000ff) << 24) | ((x & 0x0000ff00) << 8) |
+           ((x & 0x00ff0000) >> 8) | ((x & 0xff000000) >> 24);
+}
+#define BSWAP32(x) bswap32(x)
+#endif
+
+// CRC32 table for PNG chunk verification
+static const uint32_t crc32_table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+    0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+// Calculate CRC32 checksum (named apart from zlib's crc32)
+static uint32_t png_crc32(uint32_t crc, const uint8_t *buf, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        crc = (crc >> 4) ^ crc32_table[crc & 0x0f];
+        crc = (crc >> 4) ^ crc32_table[crc & 0x0f];
+    }
+    return ~crc;
+}
+
+// Write PNG file with minimal dependencies
+static int save_png(const char *filename,
+                    const uint8_t *pixels,
+                    int width,
+                    int height)
+{
+    FILE *fp = fopen(filename, "wb");
+    if (!fp)
+        return -1;
+
+    // PNG magic bytes
+    static const uint8_t png_sig[8] = {
+        0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A,
+    };
+    fwrite(png_sig, 1, 8, fp);
+
+// Helper macros for writing PNG chunks
+#define PUT_U32(u)           \
+    do {                     \
+        uint8_t b[4];        \
+        b[0] = (u) >> 24;    \
+        b[1] = (u) >> 16;    \
+        b[2] = (u) >> 8;     \
+        b[3] = (u);          \
+        fwrite(b, 1, 4, fp); \
+    } while (0)
+
+#define PUT_BYTES(buf, len) fwrite(buf, 1, len, fp)
+
+    // Write IHDR chunk
+    uint8_t ihdr[13];
+    uint32_t *p32 = (uint32_t *) ihdr;
+    p32[0] = BSWAP32(width);
+    p32[1] = BSWAP32(height);
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 6;   // color type: RGBA
+    ihdr[10] = 0;  // compression
+    ihdr[11] = 0;  // filter
+    ihdr[12] = 0;  // interlace
+
+    PUT_U32(13);  // chunk length
+    PUT_BYTES("IHDR", 4);
+    PUT_BYTES(ihdr, 13);
+    uint32_t crc = png_crc32(0, (uint8_t *) "IHDR", 4);
+    crc = png_crc32(crc, ihdr, 13);
+    PUT_U32(crc);
+
+    // Write IDAT chunk
+    size_t raw_size = height * (1 + width * 4);  // filter byte + RGBA per row
+    size_t max_deflate_size =
+        raw_size + ((raw_size + 7) >> 3) + ((raw_size + 63) >> 6) + 11;
+
+    uint8_t *idat = (uint8_t *) malloc(max_deflate_size);
+    if (!idat) {
+        fclose(fp);
+        return -1;
+    }
+
+    // Simple uncompressed DEFLATE block
+    size_t idat_size = 0;
+    idat[idat_size++] = 0x78;  // ZLIB header
+    idat[idat_size++] = 0x01;
+
+    // Write uncompressed blocks
+    uint8_t *raw_data = (uint8_t *) malloc(raw_size);
+    if (!raw_data) {
+        free(idat);
+        fclose(fp);
+        return -1;
+    }
+
+    // Convert BGRA to RGBA with filter bytes
+    // Input format: BGRA (4 bytes per pixel)
+    // Output format: filter_byte + RGBA per scanline
+    size_t raw_pos = 0;
+    for (int y = 0; y < height; y++) {
+        raw_data[raw_pos++] = 0;  // filter type: none
+        for (int x = 0; x < width; x++) {
+            int idx = (y * width + x) * 4;
+            raw_data[raw_pos++] = pixels[idx + 2];  // R (from BGRA byte 2)
+            raw_data[raw_pos++] = pixels[idx + 1];  // G (from BGRA byte 1)
+            raw_data[raw_pos++] = pixels[idx + 0];  // B (from BGRA byte 0)
+            raw_data[raw_pos++] = pixels[idx + 3];  // A (from BGRA byte 3)
+        }
+    }
+
+    // Write as uncompressed DEFLATE blocks
+    size_t pos = 0;
+    while (pos < raw_size) {
+        size_t chunk = raw_size - pos;
+        if (chunk > 65535)
+            chunk = 65535;
+
+        // final block flag
+        idat[idat_size++] = (pos + chunk >= raw_size) ? 1 : 0;
+        idat[idat_size++] = chunk & 0xff;
+        idat[idat_size++] = (chunk >> 8) & 0xff;
+        idat[idat_size++] = ~chunk & 0xff;
+        idat[idat_size++] = (~chunk >> 8) & 0xff;
+
+        memcpy(idat + idat_size, raw_data + pos, chunk);
+        idat_size += chunk;
+        pos += chunk;
+    }
+
+    // ADLER32 checksum (RFC 1950)
+    uint32_t s1 = 1, s2 = 0;
+    for (size_t i = 0; i < raw_size; i++) {
+        s1 = (s1 + raw_data[i]) % 65521;
+        s2 = (s2 + s1) % 65521;
+    }
+    uint32_t adler = (s2 << 16) | s1;
+    idat[idat_size++] = (adler >> 24) & 0xff;
+    idat[idat_size++] = (adler >> 16) & 0xff;
+    idat[idat_size++] = (adler >> 8) & 0xff;
+    idat[idat_size++] = adler & 0xff;
+
+    PUT_U32(idat_size);
+    PUT_BYTES("IDAT", 4);
+    PUT_BYTES(idat, idat_size);
+    crc = png_crc32(0, (uint8_t *) "IDAT", 4);
+    crc = png_crc32(crc, idat, idat_size);
+    PUT_U32(crc);
+
+    // Write IEND chunk
+    PUT_U32(0);
+    PUT_BYTES("IEND", 4);
+    PUT_U32(png_crc32(0, (uint8_t *) "IEND", 4));
+
+#undef PUT_U32
+#undef PUT_BYTES
+
+    free(raw_data);
+    free(idat);
+    fclose(fp);
+    return 0;
+}
+
+// Save framebuffer to PNG file
+void save_framebuffer_png(const char *filename,
+                          const std::vector<uint8_t> &fb,
+                          int w,
+                          int h)
+{
+    save_png(filename, fb.data(), w, h);
+}
+
+// Frame CRC Checker: on-chip CRC-32 against the host framebuffer
+//
+// A NYANCAT_FRAME_CRC build latches the CRC-32 of each frame's active pixels
+// (one byte {00, RRGGBB} per pixel, raster order) into frame_crc at the next
+// vsync and pulses frame_crc_valid. On that pulse the checker computes the
+// same CRC from the framebuffer, which then holds that complete frame, and
+// counts mismatches. The first latch after a reset covers no pixels and is
+// skipped.
+//
+// The host pass runs once per frame and only with --frame-crc; a board (or
+// a run compared against a list of known CRCs) needs only the register.
+template <typename Mode>
+class FrameCrcChecker
+{
+private:
+    USE_VIDEO_MODE(Mode);
+
+    struct Row {
+        uint32_t rtl, host;
+    };
+
+    std::vector<Row> rows;
+    std::vector<uint8_t> line;  // One framebuffer row as RRGGBB bytes
+    uint64_t mismatches = 0;
+    bool armed = false;  // A frame has started since reset
+
+    // CRC-32 of the framebuffer: 8-bit BGRA channels back to 2-bit values
+    // (vga2bit_to_8bit maps 0-3 to multiples of 85, so >> 6 inverts it)
+    uint32_t host_crc(const uint8_t *fb)
+    {
+        uint32_t crc = 0;
+        for (int y = 0; y < V_RES; ++y) {
+            const uint8_t *px = fb + y * H_RES * 4;
+            for (int x = 0; x < H_RES; ++x, px += 4)
+                line[x] = ((px[2] >> 6) << 4) | ((px[1] >> 6) << 2) |
+                          (px[0] >> 6);
+            crc = png_crc32(crc, line.data(), H_RES);
+        }
+        return crc;
+    }
+
+public:
+    FrameCrcChecker() : line(H_RES) {}
+
+    // frame_crc was updated by the last rising edge
+    template <typename Top>
+    static bool latched(const Top *top)
+    {
+        return top->frame_crc_valid;
+    }
+    static bool latched(const NyancatModel<Mode> *) { return false; }
+
+    // One clock, after the rising edge
+    template <typename Top>
+    void tick(const Top *top, const uint8_t *fb)
+    {
+        if (!top->reset_n) {
+            armed = false;
+            return;
+        }
+        if (!top->frame_crc_valid)
+            return;
+        if (!armed) {
+            armed = true;
+            return;
+        }
 
-// Save framebuffer to PNG file
-void save_framebuffer_png(const char *filename,
-                          const std::vector<uint8_t> &fb,
-                          int w,
-                          int h)
+        Row r = {(uint32_t) top->frame_crc, host_crc(fb)};
+        if (r.rtl != r.host) {
+            if (mismatches == 0)
+                fprintf(stderr,
+                        "[FRAME CRC] First mismatch in frame %zu: "
+                        "RTL 0x%08x, framebuffer 0x%08x\n",
+                        rows.size(), r.rtl, r.host);
+            mismatches++;
+        }
+        rows.push_back(r);
+    }
+
+    // The reference model has no CRC register
+    void tick(const NyancatModel<Mode> *, const uint8_t *) {}
+
+    void report() const
+    {
+        printf("\n========================================\n");
+        printf("On-Chip Frame CRC\n");
+        printf("========================================\n\n");
+        std::vector<uint32_t> distinct;
+        for (const Row &r : rows)
+            if (std::find(distinct.begin(), distinct.end(), r.rtl) ==
+                distinct.end())
+                distinct.push_back(r.rtl);
+        printf("Frames checked:  %zu (%zu distinct CRCs)\n", rows.size(),
+               distinct.size());
+        printf("Mismatches:      %llu\n", (unsigned long long) mismatches);
+
+        if (!rows.empty()) {
+            printf("\nPer-frame CRC-32:\n");
+            printf("  %5s %10s %10s\n", "frame", "RTL", "host");
+            size_t shown = std::min<size_t>(rows.size(), 16);
+            for (size_t i = 0; i < shown; ++i)
+                printf("  %5zu 0x%08x 0x%08x%s\n", i, rows[i].rtl,
+                       rows[i].host, rows[i].rtl != rows[i].host ? "  *" : "");
+            if (rows.size() > shown)
+                printf("  ... %zu more\n", rows.size() - shown);
+        }
+        printf("\n%s: on-chip CRC %s the framebuffer\n",
+               has_errors() || rows.empty() ? "FAIL" : "PASS",
+               rows.empty() ? "latched no frame for"
+               : mismatches ? "differs from"
+                            : "matches");
+        printf("========================================\n");
+    }
+
+    bool has_errors() const { return mismatches > 0 || rows.empty(); }
+};
+
+// Tear Detector: animation steps that land inside the picture
+//
+// A displayed frame is torn when the nyancat frame it is drawn from
+// (frame_index, or show_frame in delta builds) changes between the first and
+// the last picture row: the rows above the change show one animation frame
+// and the rows below the next. The detector samples that index on every
+// active clock of the picture rows [OFFSET_Y, OFFSET_Y + SCALED_H), once per
+// eval, and records the picture row of the first change per frame.
+//
+// FRAME_ADVANCE=vsync and FRAME_ROM=delta builds step only in vertical
+// blanking, so any tear fails the run; in an immediate-advance build the
+// step follows FRAME_PERIOD wherever it lands and the count is reported
+// only.
+template <typename Mode>
+class TearDetector
 {
-    save_png(filename, fb.data(), w, h);
-}
+private:
+    USE_VIDEO_MODE(Mode);
+    static constexpr int PIC_Y0 = NyancatModel<Mode>::OFFSET_Y;
+    static constexpr int PIC_Y1 = PIC_Y0 + NyancatModel<Mode>::SCALED_H;
+
+    struct Tear {
+        uint64_t frame;
+        int line;  // Picture row of the first changed clock
+        uint8_t from, to;
+    };
+
+    std::vector<Tear> tears;
+    uint64_t frames = 0;  // Displayed frames with every picture row seen
+    uint8_t first = 0;    // Index at the frame's first picture clock
+    int prev_y = -1;      // Picture row of the last active clock
+    bool in_frame = false, torn = false;
+
+    void close_frame()
+    {
+        if (in_frame && prev_y == PIC_Y1 - 1)
+            frames++;
+        in_frame = false;
+    }
+
+public:
+    static constexpr bool STRICT =
+        NYANCAT_FRAME_VSYNC || NYANCAT_FRAME_DELTA;
+
+    // One eval, after the rising edge
+    void tick(bool activevideo, const ProbeState &p)
+    {
+        int y = (int) p.vc - V_BLANKING;
+        if (!activevideo || y < PIC_Y0 || y >= PIC_Y1)
+            return;
+
+        if (!in_frame || y < prev_y) {
+            close_frame();
+            in_frame = true;
+            torn = false;
+            first = p.shown_frame;
+        } else if (!torn && p.shown_frame != first) {
+            torn = true;
+            tears.push_back({frames, y, first, p.shown_frame});
+        }
+        prev_y = y;
+    }
+
+    // Count the trailing frame if its last picture row was reached
+    void finish() { close_frame(); }
+
+    void report() const
+    {
+        printf("\n========================================\n");
+        printf("Frame Tearing\n");
+        printf("========================================\n\n");
+        printf("Advance:         %s\n",
+               NYANCAT_FRAME_DELTA   ? "delta (show_frame swaps in vblank)"
+               : NYANCAT_FRAME_VSYNC ? "vsync (steps latched to vblank)"
+                                     : "immediate (steps on FRAME_PERIOD)");
+        printf("Frames checked:  %llu (picture rows %d-%d)\n",
+               (unsigned long long) frames, PIC_Y0, PIC_Y1 - 1);
+        printf("Torn frames:     %zu\n", tears.size());
+
+        if (!tears.empty()) {
+            printf("\nTears:\n");
+            printf("  %5s %6s %10s\n", "frame", "line", "frames");
+            size_t shown = std::min<size_t>(tears.size(), 16);
+            for (size_t i = 0; i < shown; ++i)
+                printf("  %5llu %6d %3u -> %-3u\n",
+                       (unsigned long long) tears[i].frame, tears[i].line,
+                       tears[i].from, tears[i].to);
+            if (tears.size() > shown)
+                printf("  ... %zu more\n", tears.size() - shown);
+        }
+        if (STRICT)
+            printf("\n%s: %s\n", has_errors() ? "FAIL" : "PASS",
+                   frames == 0       ? "no complete frame was displayed"
+                   : tears.empty() ? "every animation step landed in vblank"
+                                   : "animation steps landed in the picture");
+        else
+            printf("\nINFO: immediate advance tears by design; build with "
+                   "FRAME_ADVANCE=vsync to latch steps to vblank\n");
+        printf("========================================\n");
+    }
+
+    bool has_errors() const
+    {
+        return STRICT && (frames == 0 || !tears.empty());
+    }
+};
+
+// Waveform filters: --trace-scope/--trace-depth map onto the writer's
+// dumpvars() (must be applied before open()). Scopes use waveform names
+// below TOP, e.g. "vga_nyancat.nyan"; depth 1 keeps only the signals of the
+// scope itself, 0 keeps the whole subtree.
+struct TraceFilter {
+    std::vector<std::string> scopes;
+    int depth = 0;
+
+    bool active() const { return !scopes.empty() || depth > 0; }
+
+    void apply(TraceWriter *tfp) const
+    {
+#if VM_TRACE
+        int level = depth > 0 ? depth : 99;
+        if (scopes.empty()) {
+            tfp->dumpvars(level, "TOP.vga_nyancat");
+            return;
+        }
+        for (const std::string &scope : scopes)
+            tfp->dumpvars(level, "TOP." + scope);
+#else
+        (void) tfp;
+#endif
+    }
+
+    std::string describe() const
+    {
+        std::string text = scopes.empty() ? "vga_nyancat" : "";
+        for (size_t i = 0; i < scopes.size(); ++i)
+            text += (i ? ", " : "") + scopes[i];
+        if (depth > 0)
+            text += " (depth " + std::to_string(depth) + ")";
+        return text;
+    }
+};
+
+// Trace Size Estimator: What will this waveform cost on disk?
+//
+// Traces a scratch model instance for two short windows with the same
+// filter and writer as the real run, then fits size = initial + rate*clocks.
+// The initial term covers the header and first full-value dump (dominated
+// by frame_mem when it is in scope); the rate covers per-clock changes.
+//
+// Design principles:
+//   - Measure the real writer instead of guessing from signal lists
+//   - Calibrate inside the active display (rrggbb toggling), so the result
+//     is an upper bound for blanking-heavy windows
+//   - Scratch models and files never touch the real run
+template <typename Mode, typename Vtop>
+class TraceSizeEstimator
+{
+    USE_VIDEO_MODE(Mode);
+
+public:
+    // Lines traced by the short and long calibration windows
+    static constexpr int SHORT_LINES = 4, LONG_LINES = 8;
+
+    explicit TraceSizeEstimator(const char *trace_file)
+        : scratch_file(std::string(trace_file) + ".estimate")
+    {
+    }
+
+    // Print the standard scope breakdown plus the selected filter
+    void report(const TraceFilter &selected, int64_t trace_clocks)
+    {
+        TraceFilter ports, sync, nyan, all;
+        ports.scopes = {"vga_nyancat"};
+        ports.depth = 1;
+        sync.scopes = {"vga_nyancat.vga_sync"};
+        nyan.scopes = {"vga_nyancat.nyan"};
+
+        std::cout << "Trace size estimate for " << trace_clocks
+                  << " clocks (" TRACE_FORMAT "):\n";
+        printf("  %-32s %12s %12s %12s\n", "Scope", "Initial KB",
+               "Bytes/clock", "Total MB");
+        row("vga_nyancat (top level only)", ports, trace_clocks);
+        row("vga_nyancat.vga_sync", sync, trace_clocks);
+        row("vga_nyancat.nyan", nyan, trace_clocks);
+        row("vga_nyancat (everything)", all, trace_clocks);
+        if (selected.active())
+            row(("selected: " + selected.describe()).c_str(), selected,
+                trace_clocks);
+        remove(scratch_file.c_str());
+    }
+
+private:
+    std::string scratch_file;
+
+    void row(const char *label,
+             const TraceFilter &filter,
+             int64_t trace_clocks)
+    {
+        long short_bytes = measure(filter, SHORT_LINES * H_TOTAL);
+        long long_bytes = measure(filter, LONG_LINES * H_TOTAL);
+        if (short_bytes < 0 || long_bytes < 0) {
+            printf("  %-32s %12s\n", label, "n/a");
+            return;
+        }
+        double rate = double(long_bytes - short_bytes) /
+                      ((LONG_LINES - SHORT_LINES) * H_TOTAL);
+        if (rate < 0)
+            rate = 0;
+        double initial = short_bytes - rate * SHORT_LINES * H_TOTAL;
+        if (initial < 0)
+            initial = 0;
+        printf("  %-32s %12.1f %12.2f %12.2f\n", label, initial / 1024.0,
+               rate, (initial + rate * trace_clocks) / (1024.0 * 1024.0));
+    }
+
+    // Trace `clocks` clocks of a scratch model; returns file size or -1
+    long measure(const TraceFilter &filter, int clocks)
+    {
+        Vtop *model = new Vtop;
+        TraceWriter *tfp = new TraceWriter;
+#if VM_TRACE
+        model->trace(tfp, 99);
+#endif
+        filter.apply(tfp);
+        tfp->open(scratch_file.c_str());
+
+        // Reset, then run untraced into the active display
+        model->reset_n = 0;
+        for (int i = 0; i < 16; ++i) {
+            model->clk = i & 1;
+            model->eval();
+        }
+        model->reset_n = 1;
+        for (int i = 0; i < (V_BLANKING + 16) * H_TOTAL; ++i) {
+            model->clk = 0;
+            model->eval();
+            model->clk = 1;
+            model->eval();
+        }
+
+        vluint64_t time = 0;
+        for (int i = 0; i < clocks; ++i) {
+            model->clk = 0;
+            model->eval();
+            tfp->dump(time++);
+            model->clk = 1;
+            model->eval();
+            tfp->dump(time++);
+        }
+        tfp->close();
+        delete tfp;
+        model->final();
+        delete model;
+
+        struct stat st;
+        if (stat(scratch_file.c_str(), &st) != 0)
+            return -1;
+        return st.st_size;
+    }
+};
 
 void print_usage(const char *prog)
 {
@@ -1193,15 +3000,60 @@ void print_usage(const char *prog)
         << "Usage: " << prog << " [options]\n"
         << "Options:\n"
         << "  --save-png <file>       Save single frame to PNG and exit\n"
+        << "  --frames <N>            Simulate N frames in batch mode "
+           "(default: 1)\n"
+        << "  --save-frames <fmt>     Save every batch frame to PNG "
+           "(printf pattern, e.g. frame-%03d.png)\n"
+        << "  --ref-model             Render with the C++ reference model "
+           "instead of Verilator\n"
+        << "  --lockstep              Compare reference model against RTL "
+           "every clock\n"
         << "  --trace <file.vcd>      Enable VCD waveform tracing for "
            "debugging\n"
-        << "  --trace-clocks <N>      Limit VCD trace to first N clock cycles "
+        << "                          (.vcd.gz/.vcd.zst: compressed on a "
+           "background thread)\n"
+        << "  --trace-fst <file.fst>  Enable FST waveform tracing (sim-fst "
+           "build, threaded writer)\n"
+        << "  --trace-clocks <N>      Limit waveform trace to first N clock cycles "
            "(default: 1 frame)\n"
+        << "  --trace-frames <N>      Trace N complete frames of the selected "
+           "mode (H_TOTAL*V_TOTAL clocks each)\n"
+        << "  --trace-scope <scope>   Trace only this hierarchy (repeatable, "
+           "e.g. vga_nyancat.nyan)\n"
+        << "  --trace-depth <N>       Trace N hierarchy levels below each "
+           "scope (1 = ports only)\n"
+        << "  --trace-trigger <cond>  Capture only a window around frame=K, "
+           "vsync, error or X,Y\n"
+        << "  --trace-pre <M>         Clocks kept before the trigger "
+           "(default: 1024)\n"
+        << "  --trace-post <N>        Clocks recorded after the trigger "
+           "(default: 1024)\n"
         << "  --validate-timing       Enable real-time VGA timing validation\n"
         << "  --validate-signals      Enable sync signal glitch detection\n"
         << "  --validate-coordinates  Enable coordinate bounds checking\n"
+        << "  --validate-alignment    Enable pixel pipeline alignment check\n"
         << "  --track-changes         Enable frame-to-frame change tracking\n"
         << "  --profile-render        Enable rendering performance profiling\n"
+        << "  --profile-dump <file>   Write profiler breakdown as CSV (or "
+           "JSON for *.json)\n"
+        << "  --profile-host          Report host time per simulation phase\n"
+        << "  --analyze-timing <file> Stream the analyze-vcd.py timing report "
+           "to file (no VCD)\n"
+        << "  --event-log <file.bin>  Log sync/frame transitions and "
+           "validator errors (binary)\n"
+        << "  --mode <id>             Video mode, e.g. XGA_1024x768_60 "
+           "(build/sim-all: any mode)\n"
+        << "  --wb-wait <N>           Wishbone frame memory wait states "
+           "(FRAME_MEM=wishbone)\n"
+        << "  --wb-stall <p>          Wishbone slave stall probability per "
+           "clock (0-1)\n"
+        << "  --wb-seed <S>           Seed of the injected stall pattern\n"
+        << "  --frame-crc             Check the on-chip frame CRC against the "
+           "framebuffer (FRAME_CRC=1)\n"
+        << "  --detect-tears          Report animation steps inside the "
+           "picture (fails with FRAME_ADVANCE=vsync)\n"
+        << "  --mode-switch           Reprogram the timing registers through "
+           "every mode and validate each (TIMING_REGS=1)\n"
         << "  --help                  Show this help\n\n"
         << "Interactive keys:\n"
         << "  p     - Save frame to test.png\n"
@@ -1226,6 +3078,10 @@ void print_usage(const char *prog)
            "checking\n"
         << "                          Prevents wild pointer crashes "
            "(auto-stops at 10 errors)\n"
+        << "  --validate-alignment    Checks lit region against SCALE/OFFSET_X "
+           "geometry\n"
+        << "                          Reports measured pipeline skew in "
+           "clocks\n"
         << "  --track-changes         Tracks pixel changes between frames\n"
         << "                          Reports change rate, dirty rectangles, "
            "and statistics\n"
@@ -1233,9 +3089,53 @@ void print_usage(const char *prog)
            "efficiency\n"
         << "                          Provides performance baseline for "
            "optimization "
-           "decisions\n";
+           "decisions\n"
+        << "  --lockstep              Reports first RTL/model divergence with "
+           "full model state\n"
+        << "                          Exits with failure status on any "
+           "mismatch\n"
+        << "  --profile-host          Splits wall time into eval, trace, "
+           "observers, framebuffer,\n"
+        << "                          SDL upload/present, PNG and events "
+           "(total, %, ns/clock)\n";
 }
 
+// Optional per-clock observers of simulate_frame(); null members are skipped
+template <typename Mode>
+struct Observers {
+    // Records all signal changes to the VCD/FST file; trace_time is the
+    // simulation time counter (incremented per clock edge)
+    TraceWriter *trace = nullptr;
+    vluint64_t *trace_time = nullptr;
+    // Calls tick() each clock for timing validation
+    TimingMonitor<Mode> *monitor = nullptr;
+    SyncValidator<Mode> *validator = nullptr;
+    // Validates coordinates before framebuffer writes
+    CoordinateValidator<Mode> *coord_validator = nullptr;
+    // Tracks frame changes on the vsync rising edge
+    ChangeTracker<Mode> *change_tracker = nullptr;
+    // Tracks clock utilization for performance analysis
+    RenderProfiler<Mode> *profiler = nullptr;
+    // Steps the reference model and compares outputs
+    LockstepChecker<Mode> *lockstep = nullptr;
+    // Checks lit-region placement and pipeline skew
+    AlignmentValidator<Mode> *alignment = nullptr;
+    // Times the chunk and samples per-phase host cost
+    HostProfiler *host = nullptr;
+    // Records ports/internals into its ring buffer
+    TriggeredTrace<Mode> *trigger = nullptr;
+    // Streams the analyze-vcd.py timing analysis
+    StreamingTimingAnalyzer *timing = nullptr;
+    // Logs sync/frame transitions and error counts
+    EventLog *events = nullptr;
+    // Answers the RTL's Wishbone frame reads
+    WishboneMemory<Mode> *wb_mem = nullptr;
+    // Checks each latched on-chip frame CRC
+    FrameCrcChecker<Mode> *frame_crc = nullptr;
+    // Reports animation steps inside the picture
+    TearDetector<Mode> *tears = nullptr;
+};
+
 // Simulate VGA frame generation with performance optimizations
 //
 // Executes the specified number of clock cycles, updating the framebuffer
@@ -1253,169 +3153,585 @@ void print_usage(const char *prog)
 //   - Direct pointer arithmetic for framebuffer access
 //   - Bit shifts for 4-byte alignment (hpos << 2 instead of hpos * 4)
 //
-// VCD tracing:
-//   - If trace is non-null, records all signal changes to VCD file
-//   - trace_time: simulation time counter (incremented per clock edge)
+// Observers: each non-null member of obs is ticked (see Observers
+// above); a default-constructed set only renders the frame.
+//
+// Top is either the Verilated Vvga_nyancat or the port-compatible
+// NyancatModel (reference model render mode).
 //
-// Timing validation:
-//   - If monitor is non-null, calls monitor->tick() each clock for validation
-//   - If coord_validator is non-null, validates coordinates before framebuffer
-//   writes
-//   - If change_tracker is non-null, tracks frame changes on vsync falling edge
-//   - If profiler is non-null, tracks clock utilization for performance
-//   analysis
-inline void simulate_frame(Vvga_nyancat *top,
+// clocks counts pixel clocks. With PIXELS_PER_CLOCK=2 each eval covers two
+// pixels: the trace, triggered capture and streaming timing analysis run
+// once per eval (they follow the RTL clock), while observers, the event log
+// and the framebuffer see one tick per pixel lane, so their counts and
+// periods stay in pixel clocks.
+template <typename Mode, typename Top>
+inline void simulate_frame(Top *top,
                            uint8_t *fb,
                            int &hpos,
                            int &vpos,
-                           int clocks,
-                           VerilatedVcdC *trace = nullptr,
-                           vluint64_t *trace_time = nullptr,
-                           TimingMonitor *monitor = nullptr,
-                           SyncValidator *validator = nullptr,
-                           CoordinateValidator *coord_validator = nullptr,
-                           ChangeTracker *change_tracker = nullptr,
-                           RenderProfiler *profiler = nullptr)
+                           uint64_t clocks,
+                           const Observers<Mode> &obs = {})
 {
+    USE_VIDEO_MODE(Mode);
+
     // Precompute row base address for current row
     int row_base = (vpos >= 0 && vpos < V_RES) ? (vpos * H_RES) << 2 : -1;
 
     // Track previous vsync state for edge detection (frame end tracking)
     static bool prev_vsync = true;
 
-    for (int i = 0; i < clocks; ++i) {
+    // Host profiling: one timestamp pair per chunk, phase split sampled
+    uint64_t chunk_start = obs.host ? HostProfiler::now() : 0;
+    uint64_t mark = 0;
+
+    constexpr int LANES = TopLanes<Top>::value;
+
+    for (uint64_t i = 0; i < clocks; i += LANES) {
+        bool sample = obs.host && HostProfiler::sampled(i);
+        if (sample)
+            mark = HostProfiler::now();
+
         // Clock cycle: proper edge evaluation for Verilator
         // Both edges need eval() for correct state propagation
         top->clk = 0;
         top->eval();
-        if (trace && trace_time)
-            trace->dump((*trace_time)++);
+        if (sample)
+            obs.host->lap(HostProfiler::EVAL, mark);
+        if (obs.trace && obs.trace_time) {
+            obs.trace->dump((*obs.trace_time)++);
+            if (sample)
+                obs.host->lap(HostProfiler::TRACE, mark);
+        }
 
         top->clk = 1;
         top->eval();
-        if (trace && trace_time)
-            trace->dump((*trace_time)++);
+        if (sample)
+            obs.host->lap(HostProfiler::EVAL, mark);
+        if (obs.trace && obs.trace_time) {
+            obs.trace->dump((*obs.trace_time)++);
+            if (sample)
+                obs.host->lap(HostProfiler::TRACE, mark);
+        }
 
-        // Timing validation on rising edge (after eval)
-        if (monitor)
-            monitor->tick(top->hsync, top->vsync, top->activevideo);
+#if NYANCAT_FRAME_MEM_WB
+        // External frame memory answers this clock's request; the inputs
+        // settle with the next eval, before the next rising edge
+        if (obs.wb_mem)
+            obs.wb_mem->tick(top);
+#endif
+
+        // ROM read enables for the profiler (one bit per lane)
+        ProbeState p = {};
+        if (obs.profiler)
+            p = probe_internals(top);
+
+        // Per-pixel observers on rising edge (lanes share the sync outputs)
+        for (int lane = 0; lane < LANES; ++lane) {
+            uint8_t rrggbb = lane_rrggbb(top, lane);
+
+            // Timing validation
+            if (obs.monitor)
+                obs.monitor->tick(top->hsync, top->vsync, top->activevideo);
+
+            // Sync signal validation
+            if (obs.validator)
+                obs.validator->tick(top->hsync, top->vsync);
+
+            // Performance profiling
+            if (obs.profiler)
+                obs.profiler->tick(top->vsync, top->activevideo, rrggbb,
+                                   (p.frame_rom_en >> lane) & 1,
+                                   (p.palette_rom_en >> lane) & 1);
+
+            // Reference model co-simulation (one model clock per lane)
+            if (obs.lockstep)
+                obs.lockstep->tick(top, rrggbb);
+
+            // Pixel pipeline alignment
+            if (obs.alignment)
+                obs.alignment->tick(top->vsync, top->activevideo, rrggbb);
+
+            // Binary event log (error totals only grow, so a compare per
+            // enabled checker is enough to catch new errors)
+            if (obs.events) {
+                obs.events->tick(top->hsync, top->vsync, top->activevideo,
+                                 probe_internals(top).frame_index);
+                if (obs.monitor)
+                    obs.events->errors(EventLog::SRC_TIMING,
+                                       obs.monitor->get_total_errors());
+                if (obs.validator)
+                    obs.events->errors(EventLog::SRC_SIGNALS,
+                                       obs.validator->get_total_errors());
+                if (obs.coord_validator)
+                    obs.events->errors(EventLog::SRC_COORDINATES,
+                                       obs.coord_validator->get_error_count());
+                if (obs.alignment)
+                    obs.events->errors(EventLog::SRC_ALIGNMENT,
+                                       obs.alignment->get_total_errors());
+                if (obs.lockstep)
+                    obs.events->errors(EventLog::SRC_LOCKSTEP,
+                                       obs.lockstep->get_total_errors());
+            }
+        }
 
-        // Sync signal validation on rising edge
-        if (validator)
-            validator->tick(top->hsync, top->vsync);
+        // Triggered trace capture on rising edge
+        if (obs.trigger) {
+            bool error = obs.trigger->wants_errors() &&
+                         ((obs.monitor && obs.monitor->has_errors()) ||
+                          (obs.validator && obs.validator->has_errors()) ||
+                          (obs.coord_validator &&
+                           obs.coord_validator->has_errors()) ||
+                          (obs.lockstep && obs.lockstep->has_errors()) ||
+                          (obs.alignment && obs.alignment->has_errors()));
+            obs.trigger->tick(top, error);
+        }
 
-        // Performance profiling on rising edge
-        if (profiler)
-            profiler->tick(top->activevideo, top->rrggbb);
+        // Streaming VCD-equivalent timing analysis on rising edge
+        if (obs.timing)
+            obs.timing->tick(top->hsync, top->vsync, top->activevideo);
 
         // Detect frame end: vsync rising edge (end of vertical sync pulse)
         // This marks completion of frame rendering, trigger change tracking
-        if (change_tracker && top->vsync && !prev_vsync)
-            change_tracker->track(fb);
+        // (per-frame cost is timed directly, not sampled)
+        if (obs.change_tracker && top->vsync && !prev_vsync) {
+            uint64_t t = obs.host ? HostProfiler::now() : 0;
+            obs.change_tracker->track(fb);
+            if (obs.host) {
+                obs.host->add_direct(HostProfiler::OBSERVERS,
+                                     HostProfiler::now() - t, true);
+                if (sample)
+                    mark = HostProfiler::now();
+            }
+        }
         prev_vsync = top->vsync;
 
-        // Detect frame start: both syncs go low simultaneously during vsync
-        if (!top->hsync && !top->vsync) {
-            hpos = -H_BP;
-            vpos = -V_BP;
-            row_base = -1;  // Reset row base (in blanking)
-            // Mark frame completion for coordinate validator
-            if (coord_validator)
-                coord_validator->mark_frame_complete();
-        }
-
-        // Fast path: skip processing during blanking intervals
-        // Only process when in active display region
-        if (row_base >= 0) {
-            if (hpos >= 0 && hpos < H_RES) {
-                // Coordinate validation before framebuffer write
-                // (defense-in-depth)
-                bool coords_valid = true;
-                if (coord_validator)
-                    coords_valid =
-                        coord_validator->validate(hpos, vpos, row_base);
-
-                // Only update framebuffer if coordinates pass validation
-                if (coords_valid) {
-                    // Direct framebuffer write using precomputed row base
-                    int idx = row_base + (hpos << 2);
-                    uint8_t color = top->rrggbb;
-                    fb[idx] = vga2bit_to_8bit(color & 0b11);             // B
-                    fb[idx + 1] = vga2bit_to_8bit((color >> 2) & 0b11);  // G
-                    fb[idx + 2] = vga2bit_to_8bit((color >> 4) & 0b11);  // R
-                    fb[idx + 3] = 255;                                   // A
-                }
+        // On-chip frame CRC: one framebuffer pass per latched frame
+#if NYANCAT_FRAME_CRC
+        if (obs.frame_crc) {
+            bool latched = FrameCrcChecker<Mode>::latched(top);
+            uint64_t t = obs.host && latched ? HostProfiler::now() : 0;
+            obs.frame_crc->tick(top, fb);
+            if (obs.host && latched) {
+                obs.host->add_direct(HostProfiler::OBSERVERS,
+                                     HostProfiler::now() - t, true);
+                if (sample)
+                    mark = HostProfiler::now();
             }
         }
+#endif
 
-        // Position tracking with wraparound
-        if (++hpos >= H_RES + H_FP + H_SYNC) {
-            hpos = -H_BP;
-            if (++vpos >= V_RES + V_FP + V_SYNC) {
-                vpos = -V_BP;
-                row_base = -1;
-            } else {
-                // Update row base when entering new active row
-                row_base =
-                    (vpos >= 0 && vpos < V_RES) ? (vpos * H_RES) << 2 : -1;
+        // Frame tearing (the displayed index is shared by the lanes)
+        if (obs.tears)
+            obs.tears->tick(top->activevideo, probe_internals(top));
+        if (sample)
+            obs.host->lap(HostProfiler::OBSERVERS, mark);
+
+        for (int lane = 0; lane < LANES; ++lane) {
+            // Detect frame start: both syncs go low simultaneously during
+            // vsync. The position restarts on every such clock and then
+            // still advances for it, hence the extra -1: hpos/vpos equal
+            // the active pixel whenever activevideo is high, so the
+            // framebuffer holds exactly the pixels the frame CRC folds
+            if (!top->hsync && !top->vsync) {
+                hpos = -H_BP - 1;
+                vpos = -V_BP - 1;
+                row_base = -1;  // Reset row base (in blanking)
+                // Mark frame completion for coordinate validator
+                if (obs.coord_validator)
+                    obs.coord_validator->mark_frame_complete();
+            }
+
+            // Fast path: skip processing during blanking intervals
+            // Only process when in active display region
+            if (row_base >= 0) {
+                if (hpos >= 0 && hpos < H_RES) {
+                    // Coordinate validation before framebuffer write
+                    // (defense-in-depth)
+                    bool coords_valid = true;
+                    if (obs.coord_validator)
+                        coords_valid = obs.coord_validator->validate(
+                            hpos, vpos, row_base);
+
+                    // Only update framebuffer if coordinates pass validation
+                    if (coords_valid) {
+                        // Direct framebuffer write using precomputed row base
+                        int idx = row_base + (hpos << 2);
+                        uint8_t color = lane_rrggbb(top, lane);
+                        fb[idx] = vga2bit_to_8bit(color & 0b11);  // B
+                        fb[idx + 1] =
+                            vga2bit_to_8bit((color >> 2) & 0b11);  // G
+                        fb[idx + 2] =
+                            vga2bit_to_8bit((color >> 4) & 0b11);  // R
+                        fb[idx + 3] = 255;                         // A
+                    }
+                }
+            }
+
+            // Position tracking with wraparound
+            if (++hpos >= H_RES + H_FP + H_SYNC) {
+                hpos = -H_BP;
+                if (++vpos >= V_RES + V_FP + V_SYNC) {
+                    vpos = -V_BP;
+                    row_base = -1;
+                } else {
+                    // Update row base when entering new active row
+                    row_base =
+                        (vpos >= 0 && vpos < V_RES) ? (vpos * H_RES) << 2 : -1;
+                }
             }
         }
+        if (sample)
+            obs.host->lap(HostProfiler::FRAMEBUFFER, mark);
     }
+
+    if (obs.host)
+        obs.host->add_chunk(HostProfiler::now() - chunk_start, clocks);
 }
 
-int main(int argc, char **argv)
+// Mode Switch Test: reprogram the timing registers without a reset
+//
+// A VGA_TIMING_REGS build takes its timing and SCALE/OFFSET_X from the
+// cfg_* register bus. The test writes the register set of every video mode
+// in turn and finally of the reset mode again, one register per clock,
+// then TIMING_REG_APPLY, and clocks until cfg_busy drops: the new set has
+// been loaded at the end of the running frame and the next clock starts the
+// first frame in the new mode. Two frames per mode are then checked with a
+// fresh TimingMonitor and AlignmentValidator of that mode, and the last one
+// is saved as mode-switch-<ID>.png.
+//
+// The register writes themselves run in the old mode and are not observed.
+#if VGA_TIMING_REGS
+template <typename Vtop>
+static void write_timing_reg(Vtop *top, int addr, int value)
+{
+    top->cfg_we = 1;
+    top->cfg_addr = addr;
+    top->cfg_wdata = value;
+    top->clk = 0;
+    top->eval();
+    top->clk = 1;
+    top->eval();
+    top->cfg_we = 0;
+}
+
+template <typename Mode, typename Vtop>
+static bool switch_mode(Vtop *top)
+{
+    USE_VIDEO_MODE(Mode);
+    using Model = NyancatModel<Mode>;
+
+    const int regs[][2] = {
+        {TIMING_REG_H_ACTIVE, H_RES},
+        {TIMING_REG_H_FP, H_FP},
+        {TIMING_REG_H_SYNC, H_SYNC},
+        {TIMING_REG_H_BP, H_BP},
+        {TIMING_REG_V_ACTIVE, V_RES},
+        {TIMING_REG_V_FP, V_FP},
+        {TIMING_REG_V_SYNC, V_SYNC},
+        {TIMING_REG_V_BP, V_BP},
+        {TIMING_REG_SCALE, Model::SCALE},
+        {TIMING_REG_OFFSET_X, Model::OFFSET_X},
+        {TIMING_REG_APPLY, 1},
+    };
+    for (const auto &r : regs)
+        write_timing_reg(top, r[0], r[1]);
+
+    // Applied at the end of the running frame (at most one old-mode frame)
+    int wait = 0;
+    for (; top->cfg_busy && wait < 2 * H_TOTAL_MAX * V_TOTAL_MAX; ++wait) {
+        top->clk = 0;
+        top->eval();
+        top->clk = 1;
+        top->eval();
+    }
+
+    printf("\n--- %s: applied after %d clocks ---\n", MODE_NAME, wait);
+    if (top->cfg_busy) {
+        printf("FAIL: timing registers never applied\n");
+        return false;
+    }
+
+    std::vector<uint8_t> fb(H_RES * V_RES * 4, 0);
+    int hpos = -H_BP, vpos = -V_BP;
+    TimingMonitor<Mode> monitor;
+    AlignmentValidator<Mode> alignment;
+    Observers<Mode> obs;
+    obs.monitor = &monitor;
+    obs.alignment = &alignment;
+    simulate_frame<Mode>(top, fb.data(), hpos, vpos, 2 * CLOCKS_PER_FRAME,
+                         obs);
+    monitor.report();
+    alignment.report();
+
+    char png[64];
+    snprintf(png, sizeof(png), "mode-switch-%s.png", Mode::ID);
+    save_framebuffer_png(png, fb, H_RES, V_RES);
+    std::cout << "Saved frame to " << png << std::endl;
+
+    return monitor.is_complete() && !monitor.has_errors() &&
+           alignment.is_complete() && !alignment.has_errors();
+}
+
+// Every mode, then back to the reset mode; returns the number of failures
+template <typename ResetMode, typename Vtop>
+static int run_mode_switch(Vtop *top)
+{
+    bool ok[] = {
+        switch_mode<Mode_VGA_640x480_60>(top),
+        switch_mode<Mode_VGA_800x600_60>(top),
+        switch_mode<Mode_SVGA_800x600_72>(top),
+        switch_mode<Mode_XGA_1024x768_60>(top),
+        switch_mode<Mode_VGA_640x480_72>(top),
+        switch_mode<ResetMode>(top),
+    };
+    int total = sizeof(ok) / sizeof(ok[0]), failures = 0;
+    for (bool b : ok)
+        failures += !b;
+    printf("\n%s: %d of %d mode switches validated\n",
+           failures ? "FAIL" : "PASS", total - failures, total);
+    return failures;
+}
+#endif
+
+// Simulator for one video mode: Mode is the timing traits struct and Vtop
+// the Verilated model elaborated for it (see the mode table below main)
+template <typename Mode, typename Vtop>
+int run_simulation(int argc, char **argv)
 {
+    USE_VIDEO_MODE(Mode);
+
     bool save_and_exit = false;
     bool validate_timing = false;
     bool validate_signals = false;
     bool validate_coordinates = false;
+    bool validate_alignment = false;
     bool track_changes = false;
     bool profile_render = false;
-    const char *output_file = "test.png";
+    bool use_ref_model = false;
+    bool lockstep_check = false;
+    bool profile_host = false;
+    bool check_frame_crc = false;
+    bool detect_tears = false;
+    bool mode_switch = false;
+    const char *output_file = nullptr;
+    const char *frames_pattern = nullptr;
+    int batch_frames = 1;
     const char *trace_file = nullptr;
-    int trace_clocks = CLOCKS_PER_FRAME;  // Default: 1 complete frame
+    bool trace_fst = false;
+    const char *trigger_spec = nullptr;
+    TraceFilter trace_filter;
+    int trigger_pre = 1024, trigger_post = 1024;
+    const char *profile_dump_file = nullptr;
+    const char *timing_report_file = nullptr;
+    const char *event_log_file = nullptr;
+    typename WishboneMemory<Mode>::Config wb_config;
+    bool wb_options = false;
+    int64_t trace_clocks = CLOCKS_PER_FRAME;  // Default: 1 complete frame
 
     // Command line argument parsing
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--save-png") == 0 && i + 1 < argc) {
             save_and_exit = true;
             output_file = argv[++i];
+        } else if (strcmp(argv[i], "--save-frames") == 0 && i + 1 < argc) {
+            save_and_exit = true;
+            frames_pattern = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            batch_frames = atoi(argv[++i]);
+            if (batch_frames < 1)
+                batch_frames = 1;
+        } else if (strcmp(argv[i], "--ref-model") == 0) {
+            use_ref_model = true;
+        } else if (strcmp(argv[i], "--lockstep") == 0) {
+            lockstep_check = true;
         } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
             trace_file = argv[++i];
+            trace_fst = false;
+        } else if (strcmp(argv[i], "--trace-fst") == 0 && i + 1 < argc) {
+            trace_file = argv[++i];
+            trace_fst = true;
         } else if (strcmp(argv[i], "--trace-clocks") == 0 && i + 1 < argc) {
-            trace_clocks = atoi(argv[++i]);
+            trace_clocks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--trace-frames") == 0 && i + 1 < argc) {
+            // Plus the 8 reset clocks, whose two edges each count against
+            // the limit, so the last frame is not cut short
+            trace_clocks =
+                std::max<int64_t>(1, atoll(argv[++i])) * CLOCKS_PER_FRAME +
+                2 * 8;
+        } else if (strcmp(argv[i], "--trace-depth") == 0 && i + 1 < argc) {
+            trace_filter.depth = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--trace-scope") == 0 && i + 1 < argc) {
+            trace_filter.scopes.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--trace-trigger") == 0 && i + 1 < argc) {
+            trigger_spec = argv[++i];
+        } else if (strcmp(argv[i], "--trace-pre") == 0 && i + 1 < argc) {
+            trigger_pre = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--trace-post") == 0 && i + 1 < argc) {
+            trigger_post = std::max(0, atoi(argv[++i]));
         } else if (strcmp(argv[i], "--validate-timing") == 0) {
             validate_timing = true;
         } else if (strcmp(argv[i], "--validate-signals") == 0) {
             validate_signals = true;
         } else if (strcmp(argv[i], "--validate-coordinates") == 0) {
             validate_coordinates = true;
+        } else if (strcmp(argv[i], "--validate-alignment") == 0) {
+            validate_alignment = true;
         } else if (strcmp(argv[i], "--track-changes") == 0) {
             track_changes = true;
         } else if (strcmp(argv[i], "--profile-render") == 0) {
             profile_render = true;
-        } else if (strcmp(argv[i], "--help") == 0) {
-            print_usage(argv[0]);
-            return EXIT_SUCCESS;
+        } else if (strcmp(argv[i], "--profile-dump") == 0 && i + 1 < argc) {
+            profile_render = true;
+            profile_dump_file = argv[++i];
+        } else if (strcmp(argv[i], "--analyze-timing") == 0 && i + 1 < argc) {
+            timing_report_file = argv[++i];
+        } else if (strcmp(argv[i], "--event-log") == 0 && i + 1 < argc) {
+            event_log_file = argv[++i];
+        } else if (strcmp(argv[i], "--profile-host") == 0) {
+            profile_host = true;
+        } else if (strcmp(argv[i], "--frame-crc") == 0) {
+            check_frame_crc = true;
+        } else if (strcmp(argv[i], "--detect-tears") == 0) {
+            detect_tears = true;
+        } else if (strcmp(argv[i], "--mode-switch") == 0) {
+            mode_switch = true;
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            ++i;  // Selected by main()
+        } else if (strcmp(argv[i], "--wb-wait") == 0 && i + 1 < argc) {
+            wb_config.wait_states = std::max(0, atoi(argv[++i]));
+            wb_options = true;
+        } else if (strcmp(argv[i], "--wb-stall") == 0 && i + 1 < argc) {
+            wb_config.stall_rate =
+                std::min(1.0, std::max(0.0, atof(argv[++i])));
+            wb_options = true;
+        } else if (strcmp(argv[i], "--wb-seed") == 0 && i + 1 < argc) {
+            wb_config.seed = strtoul(argv[++i], nullptr, 0);
+            wb_options = true;
         }
     }
 
+    if (wb_options && !NYANCAT_FRAME_MEM_WB) {
+        fprintf(stderr,
+                "Error: --wb-* options need the external frame memory build "
+                "(make FRAME_MEM=wishbone)\n");
+        return EXIT_FAILURE;
+    }
+
+    if (check_frame_crc && !NYANCAT_FRAME_CRC) {
+        fprintf(stderr,
+                "Error: --frame-crc needs the on-chip frame CRC build (make "
+                "FRAME_CRC=1)\n");
+        return EXIT_FAILURE;
+    }
+    if (check_frame_crc && use_ref_model) {
+        fprintf(stderr,
+                "Error: --frame-crc checks the RTL CRC register; the "
+                "reference model has none\n");
+        return EXIT_FAILURE;
+    }
+
+    if (mode_switch && !VGA_TIMING_REGS) {
+        fprintf(stderr,
+                "Error: --mode-switch needs the programmable timing build "
+                "(make TIMING_REGS=1)\n");
+        return EXIT_FAILURE;
+    }
+    if (mode_switch && (use_ref_model || trace_file || NYANCAT_FRAME_MEM_WB)) {
+        fprintf(stderr,
+                "Error: --mode-switch runs the ROM-based RTL on its own (no "
+                "--ref-model, --trace or FRAME_MEM=wishbone)\n");
+        return EXIT_FAILURE;
+    }
+
+    if (trace_file && is_compressed_trace(trace_file) &&
+        (trace_fst || trigger_spec || !TRACE_COMPRESSION)) {
+        fprintf(stderr,
+                "Error: compressed traces (.vcd.gz/.vcd.zst) are supported "
+                "for full VCD traces with build/sim only\n");
+        return EXIT_FAILURE;
+    }
+#if TRACE_COMPRESSION
+    if (trace_file &&
+        !TraceFile::is_available(TraceFile::codec_for(trace_file))) {
+        fprintf(stderr,
+                "Error: %s needs zstd support (rebuild with libzstd "
+                "installed)\n",
+                trace_file);
+        return EXIT_FAILURE;
+    }
+#endif
+
+    if (trigger_spec && !trace_file) {
+        fprintf(stderr,
+                "Error: --trace-trigger requires --trace <file.vcd> or "
+                "--trace-fst <file.fst>\n");
+        return EXIT_FAILURE;
+    }
+
+#if !VM_TRACE
+    if (trace_file && !trigger_spec) {
+        fprintf(stderr,
+                "Error: tracing is not available in the fast build (rebuild "
+                "with 'make build' and use build/sim)\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // Verilator links exactly one trace format into each model. Triggered
+    // VCD captures are written by the harness itself and work in any build;
+    // triggered FST captures still need the FST library of build/sim-fst.
+    if (trace_file && (!trigger_spec || trace_fst) &&
+        trace_fst != (VM_TRACE_FST != 0)) {
+        fprintf(stderr, "Error: this build writes %s traces; use %s for %s\n",
+                TRACE_FORMAT,
+                trace_fst ? "build/sim-fst (make fst)" : "build/sim",
+                trace_fst ? "--trace-fst" : "--trace");
+        return EXIT_FAILURE;
+    }
+
+    if (use_ref_model && !save_and_exit) {
+        fprintf(stderr,
+                "Error: --ref-model requires batch mode (--save-png or "
+                "--save-frames)\n");
+        return EXIT_FAILURE;
+    }
+
     // Initialize Verilator
     Verilated::commandArgs(argc, argv);
-    Verilated::traceEverOn(true);  // Enable tracing for VCD generation
-    Vvga_nyancat *top = new Vvga_nyancat;
-
-    // Initialize VCD tracing if requested
-    VerilatedVcdC *trace = nullptr;
+    Verilated::traceEverOn(true);  // Enable tracing for VCD/FST generation
+    Vtop *top = new Vtop;
+
+    // Initialize waveform tracing if requested
+    // FST: compression and file I/O run on Verilator's trace thread
+    // (--trace-threads), the eval thread only hands off value changes
+    TraceWriter *trace = nullptr;
+#if TRACE_COMPRESSION
+    TraceFile *trace_sink = nullptr;  // Owned here, not by VerilatedVcdC
+#endif
     vluint64_t trace_time = 0;
-    int remaining_trace_clocks = trace_clocks;
+    int64_t remaining_trace_clocks = trace_clocks;
+
+    if (trace_file && !trigger_spec) {
+        // Estimate first, so an oversized capture can be aborted early
+        TraceSizeEstimator<Mode, Vtop>(trace_file).report(trace_filter,
+                                                          trace_clocks);
 
-    if (trace_file) {
-        trace = new VerilatedVcdC;
-        top->trace(trace, 99);  // Trace 99 levels of hierarchy
+#if TRACE_COMPRESSION
+        trace_sink = new TraceFile(TraceFile::codec_for(trace_file));
+        trace = new TraceWriter(trace_sink);
+#else
+        trace = new TraceWriter;
+#endif
+#if VM_TRACE
+        top->trace(trace, 99);  // Full hierarchy, narrowed by dumpvars()
+#endif
+        if (trace_filter.active())
+            trace_filter.apply(trace);
         trace->open(trace_file);
-        std::cout << "VCD tracing enabled: " << trace_file << "\n";
+        std::cout << TRACE_FORMAT " tracing enabled: " << trace_file << "\n";
         std::cout << "Trace duration: " << trace_clocks << " clock cycles\n";
+        if (trace_filter.active())
+            std::cout << "Trace scope: " << trace_filter.describe() << "\n";
     }
 
     // Perform reset sequence: hold reset for multiple cycles to ensure
@@ -1440,6 +3756,16 @@ int main(int argc, char **argv)
     top->clk = 0;
     top->eval();
 
+#if VGA_TIMING_REGS
+    // Mode switch test: batch run without SDL or the other observers
+    if (mode_switch) {
+        int failures = run_mode_switch<Mode>(top);
+        top->final();
+        delete top;
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+#endif
+
     // Initialize SDL subsystem
     SDL_Init(SDL_INIT_VIDEO);
 
@@ -1471,9 +3797,9 @@ int main(int argc, char **argv)
     int vpos = -V_BP;
 
     // Initialize timing monitor if requested
-    TimingMonitor *monitor = nullptr;
+    TimingMonitor<Mode> *monitor = nullptr;
     if (validate_timing) {
-        monitor = new TimingMonitor();
+        monitor = new TimingMonitor<Mode>();
         std::cout << "VGA timing validation enabled\n";
         std::cout << "Expected timing: H_TOTAL=" << H_TOTAL
                   << " V_TOTAL=" << V_TOTAL << " H_SYNC=" << H_SYNC
@@ -1481,71 +3807,259 @@ int main(int argc, char **argv)
     }
 
     // Initialize sync signal validator if requested
-    SyncValidator *validator = nullptr;
+    SyncValidator<Mode> *validator = nullptr;
     if (validate_signals) {
-        validator = new SyncValidator();
+        validator = new SyncValidator<Mode>();
         std::cout << "Sync signal validation enabled\n";
         std::cout << "Glitch detection with phase-aware diagnostics\n";
     }
 
     // Initialize coordinate validator if requested
-    CoordinateValidator *coord_validator = nullptr;
+    CoordinateValidator<Mode> *coord_validator = nullptr;
     if (validate_coordinates) {
-        coord_validator = new CoordinateValidator();
+        coord_validator = new CoordinateValidator<Mode>();
         std::cout << "Coordinate validation enabled\n";
         std::cout
             << "Defense-in-depth bounds checking (auto-stops at 10 errors)\n";
     }
 
+    // Initialize pixel alignment validator if requested
+    AlignmentValidator<Mode> *alignment = nullptr;
+    if (validate_alignment) {
+        alignment = new AlignmentValidator<Mode>();
+        std::cout << "Pixel alignment validation enabled\n";
+        std::cout << "Checking lit region against SCALE="
+                  << NyancatModel<Mode>::SCALE
+                  << " OFFSET_X=" << NyancatModel<Mode>::OFFSET_X
+                  << " and pipeline skew\n";
+    }
+
     // Initialize change tracker if requested
-    ChangeTracker *change_tracker = nullptr;
+    ChangeTracker<Mode> *change_tracker = nullptr;
     if (track_changes) {
-        change_tracker = new ChangeTracker();
+        change_tracker = new ChangeTracker<Mode>();
         std::cout << "Frame change tracking enabled\n";
         std::cout
             << "Tracking pixel-level changes between consecutive frames\n";
     }
 
     // Initialize render profiler if requested
-    RenderProfiler *profiler = nullptr;
+    RenderProfiler<Mode> *profiler = nullptr;
     if (profile_render) {
-        profiler = new RenderProfiler();
+        profiler = new RenderProfiler<Mode>();
         std::cout << "Render performance profiling enabled\n";
         std::cout
             << "Clock-level utilization tracking for performance analysis\n";
     }
 
+    // Initialize lockstep co-simulation if requested
+    LockstepChecker<Mode> *lockstep = nullptr;
+    if (lockstep_check) {
+        lockstep = new LockstepChecker<Mode>();
+        if (!lockstep->is_loaded())
+            return EXIT_FAILURE;
+        std::cout << "Lockstep co-simulation enabled\n";
+        std::cout << "Comparing reference model outputs against RTL every "
+                     "clock\n";
+    }
+
+    // Reference model render mode: model replaces the Verilated design
+    NyancatModel<Mode> *ref_model = nullptr;
+    if (use_ref_model) {
+        ref_model = new NyancatModel<Mode>();
+        if (!ref_model->load())
+            return EXIT_FAILURE;
+        ref_model->reset_n = 0;
+        for (int i = 0; i < 8; ++i) {
+            ref_model->clk = 0;
+            ref_model->eval();
+            ref_model->clk = 1;
+            ref_model->eval();
+        }
+        ref_model->reset_n = 1;
+        ref_model->clk = 0;
+        ref_model->eval();
+        std::cout << "Rendering with C++ reference model (Verilator idle)\n";
+    }
+
+    // Initialize host time profiler if requested
+    HostProfiler *host = nullptr;
+    if (profile_host) {
+        host = new HostProfiler();
+        std::cout << "Host time profiling enabled\n";
+        std::cout << "Sampling 1/" << HostProfiler::SAMPLE_INTERVAL
+                  << " clocks for eval/trace/observer/framebuffer split\n";
+    }
+
+    // Initialize streaming timing analysis if requested
+    StreamingTimingAnalyzer *timing = nullptr;
+    if (timing_report_file) {
+        timing = new StreamingTimingAnalyzer();
+        std::cout << "Streaming timing analysis enabled (report: "
+                  << timing_report_file << ")\n";
+    }
+
+    // Initialize binary event log if requested
+    EventLog *events = nullptr;
+    if (event_log_file) {
+        events = new EventLog();
+        if (!events->open(event_log_file, MODE_NAME, H_RES, V_RES, H_TOTAL,
+                          V_TOTAL)) {
+            fprintf(stderr, "Error: cannot write %s\n", event_log_file);
+            return EXIT_FAILURE;
+        }
+        std::cout << "Event log enabled: " << event_log_file << "\n";
+    }
+
+    // External frame memory: the Wishbone build has no frame ROM, so the
+    // slave model is always attached
+    WishboneMemory<Mode> *wb_mem = nullptr;
+    if (NYANCAT_FRAME_MEM_WB) {
+        wb_mem = new WishboneMemory<Mode>(wb_config);
+        if (!wb_mem->load())
+            return EXIT_FAILURE;
+        std::cout << "Wishbone frame memory: " << wb_config.wait_states
+                  << " wait states, stall rate " << wb_config.stall_rate
+                  << "\n";
+    }
+
+    // Initialize on-chip frame CRC check if requested
+    FrameCrcChecker<Mode> *frame_crc = nullptr;
+    if (check_frame_crc) {
+        frame_crc = new FrameCrcChecker<Mode>();
+        std::cout << "Frame CRC check enabled\n";
+        std::cout << "Comparing the RTL's per-frame CRC-32 against the "
+                     "framebuffer at every vsync\n";
+    }
+
+    // Initialize frame tearing detection if requested
+    TearDetector<Mode> *tears = nullptr;
+    if (detect_tears) {
+        tears = new TearDetector<Mode>();
+        std::cout << "Tear detection enabled\n";
+        std::cout << "Checking that each displayed frame shows one animation "
+                     "frame"
+                  << (TearDetector<Mode>::STRICT ? "" : " (report only)")
+                  << "\n";
+    }
+
+    // Initialize triggered trace capture if requested
+    TriggeredTrace<Mode> *trigger = nullptr;
+    if (trigger_spec) {
+        trigger = TriggeredTrace<Mode>::create(trigger_spec, trace_file,
+                                               trace_fst, trigger_pre,
+                                               trigger_post);
+        if (!trigger)
+            return EXIT_FAILURE;
+        std::cout << "Triggered tracing enabled: " << trigger_spec << " -> "
+                  << trace_file << "\n";
+        std::cout << "Capture window: " << trigger_pre << " clocks before, "
+                  << trigger_post << " clocks after trigger\n";
+        if (strcmp(trigger_spec, "error") == 0 && !monitor && !validator &&
+            !coord_validator && !lockstep && !alignment)
+            fprintf(stderr,
+                    "Warning: --trace-trigger error without any "
+                    "--validate-*/--lockstep option never fires\n");
+    }
+
+    // Observers shared by the RTL and the reference model; lockstep,
+    // Wishbone memory and frame CRC need the Verilated RTL
+    Observers<Mode> observers;
+    observers.monitor = monitor;
+    observers.validator = validator;
+    observers.coord_validator = coord_validator;
+    observers.change_tracker = change_tracker;
+    observers.profiler = profiler;
+    observers.alignment = alignment;
+    observers.host = host;
+    observers.trigger = trigger;
+    observers.timing = timing;
+    observers.events = events;
+    observers.tears = tears;
+    Observers<Mode> rtl_observers = observers;
+    rtl_observers.lockstep = lockstep;
+    rtl_observers.wb_mem = wb_mem;
+    rtl_observers.frame_crc = frame_crc;
+
     bool quit = false;
+    bool failed = false;
 
-    // Batch mode: generate one frame and exit
+    // Batch mode: generate one or more frames and exit
     if (save_and_exit) {
-        // Simulate exactly one complete frame
+        // Simulate complete frames
         // For timing validation, simulate extra lines to ensure second vsync
         // edge
-        int sim_clocks = CLOCKS_PER_FRAME;
-        if (validate_timing) {
+        uint64_t sim_clocks = (uint64_t) CLOCKS_PER_FRAME * batch_frames;
+        int extra_clocks = 0;
+        if (validate_timing || frame_crc) {
             // Add extra lines to ensure we see second vsync falling edge
-            sim_clocks += H_TOTAL * (V_FP + V_SYNC + 1);
+            // (and the CRC of the last frame, latched at that vsync)
+            extra_clocks = H_TOTAL * (V_FP + V_SYNC + 1);
+            sim_clocks += extra_clocks;
         }
         if (trace && remaining_trace_clocks > 0) {
-            sim_clocks = (remaining_trace_clocks < sim_clocks)
-                             ? remaining_trace_clocks
-                             : sim_clocks;
+            sim_clocks =
+                std::min<uint64_t>(remaining_trace_clocks, sim_clocks);
         }
 
-        simulate_frame(top, fb_ptr, hpos, vpos, sim_clocks, trace, &trace_time,
-                       monitor, validator, coord_validator, change_tracker,
-                       profiler);
+        // VCD tracing records the RTL only
+        Observers<Mode> batch_observers = rtl_observers;
+        batch_observers.trace = trace;
+        batch_observers.trace_time = &trace_time;
+        auto run_clocks = [&](uint64_t clocks) {
+            if (ref_model)
+                simulate_frame<Mode>(ref_model, fb_ptr, hpos, vpos, clocks,
+                                     observers);
+            else
+                simulate_frame<Mode>(top, fb_ptr, hpos, vpos, clocks,
+                                     batch_observers);
+        };
+
+        // Run frame by frame so every completed frame can be exported
+        auto start = std::chrono::steady_clock::now();
+        uint64_t clocks_left = sim_clocks;
+        for (int frame = 0; frame < batch_frames && clocks_left > 0; ++frame) {
+            uint64_t chunk = std::min<uint64_t>(CLOCKS_PER_FRAME, clocks_left);
+            run_clocks(chunk);
+            clocks_left -= chunk;
+
+            if (frames_pattern && chunk == CLOCKS_PER_FRAME) {
+                char frame_file[512];
+                snprintf(frame_file, sizeof(frame_file), frames_pattern,
+                         frame);
+                HostPhaseTimer t(host, HostProfiler::PNG);
+                save_framebuffer_png(frame_file, framebuffer, H_RES, V_RES);
+            }
+        }
+        if (clocks_left > 0)
+            run_clocks(clocks_left);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
         if (trace) {
-            remaining_trace_clocks -= sim_clocks * 2;  // 2 edges per clock
+            // 2 edges per clock
+            remaining_trace_clocks -= (int64_t) sim_clocks * 2;
         }
 
+        std::cout << "Simulated " << sim_clocks << " clocks in "
+                  << elapsed.count() << " s ("
+                  << (sim_clocks / elapsed.count() / 1e6) << " Mclk/s, "
+                  << (ref_model ? "reference model" : "Verilator") << ")\n";
+        if (frames_pattern)
+            std::cout << "Saved " << batch_frames << " frames to "
+                      << frames_pattern << std::endl;
+
         // Update SDL texture and save PNG
-        SDL_UpdateTexture(texture, nullptr, fb_ptr, H_RES * 4);
-        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-        SDL_RenderPresent(renderer);
-        save_framebuffer_png(output_file, framebuffer, H_RES, V_RES);
-        std::cout << "Saved frame to " << output_file << std::endl;
+        {
+            HostPhaseTimer t(host, HostProfiler::TEXTURE);
+            SDL_UpdateTexture(texture, nullptr, fb_ptr, H_RES * 4);
+            SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+            SDL_RenderPresent(renderer);
+        }
+        if (output_file) {
+            HostPhaseTimer t(host, HostProfiler::PNG);
+            save_framebuffer_png(output_file, framebuffer, H_RES, V_RES);
+            std::cout << "Saved frame to " << output_file << std::endl;
+        }
 
         quit = true;
     }
@@ -1554,6 +4068,7 @@ int main(int argc, char **argv)
     // Performance: simulate in batches and update display periodically
     while (!quit) {
         // Process SDL events
+        uint64_t events_start = host ? HostProfiler::now() : 0;
         SDL_Event e;
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
@@ -1563,28 +4078,38 @@ int main(int argc, char **argv)
                 case SDLK_q:
                     quit = true;
                     break;
-                case SDLK_p:
+                case SDLK_p: {
+                    HostPhaseTimer t(host, HostProfiler::PNG);
                     save_framebuffer_png("test.png", framebuffer, H_RES, V_RES);
+                    // Keep PNG time out of the event polling phase
+                    if (host)
+                        events_start += HostProfiler::now() - t.started();
                     std::cout << "Saved frame to test.png" << std::endl;
                     break;
                 }
+                }
             }
         }
 
         // Read keyboard state for controls
         auto keystate = SDL_GetKeyboardState(nullptr);
         top->reset_n = !keystate[SDL_SCANCODE_ESCAPE];
+        if (host)
+            host->add_direct(HostProfiler::EVENTS,
+                             HostProfiler::now() - events_start);
 
         // Simulate in smaller chunks for responsive input
         // VCD tracing disabled in interactive mode (too much data)
-        simulate_frame(top, fb_ptr, hpos, vpos, 50000, nullptr, nullptr,
-                       monitor, validator, coord_validator, change_tracker,
-                       profiler);
+        simulate_frame<Mode>(top, fb_ptr, hpos, vpos, 50000,
+                             rtl_observers);
 
         // Update display after each simulation chunk
-        SDL_UpdateTexture(texture, nullptr, fb_ptr, H_RES * 4);
-        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-        SDL_RenderPresent(renderer);
+        {
+            HostPhaseTimer t(host, HostProfiler::TEXTURE);
+            SDL_UpdateTexture(texture, nullptr, fb_ptr, H_RES * 4);
+            SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+            SDL_RenderPresent(renderer);
+        }
 
         // Check if timing validation is complete
         if (monitor && monitor->is_complete()) {
@@ -1610,20 +4135,111 @@ int main(int argc, char **argv)
         delete coord_validator;
     }
 
+    if (alignment) {
+        alignment->report();
+        failed |= alignment->has_errors();
+        delete alignment;
+    }
+
     if (change_tracker) {
         change_tracker->report();
         delete change_tracker;
     }
 
     if (profiler) {
+        profiler->finish();
         profiler->report();
+        if (profile_dump_file) {
+            if (profiler->dump(profile_dump_file))
+                std::cout << "Profile data written to " << profile_dump_file
+                          << "\n";
+            else
+                fprintf(stderr, "Error: cannot write %s\n", profile_dump_file);
+        }
         delete profiler;
     }
 
+    if (lockstep) {
+        lockstep->report();
+        failed |= lockstep->has_errors();
+        delete lockstep;
+    }
+
+    if (wb_mem) {
+        wb_mem->finish();
+        wb_mem->report();
+        failed |= wb_mem->total_misses() > 0;
+        failed |= wb_mem->hold_violations() > 0;
+        delete wb_mem;
+    }
+
+    if (frame_crc) {
+        frame_crc->report();
+        failed |= frame_crc->has_errors();
+        delete frame_crc;
+    }
+
+    if (tears) {
+        tears->finish();
+        tears->report();
+        failed |= tears->has_errors();
+        delete tears;
+    }
+
+    if (timing) {
+        failed |= !timing->report(timing_report_file);
+        failed |= timing->has_errors();
+        delete timing;
+    }
+
+    if (events) {
+        events->close();
+        printf("Event log: %llu records, %llu bytes for %llu clocks "
+               "(%.4f bytes/clock)\n",
+               (unsigned long long) events->records(),
+               (unsigned long long) events->bytes(),
+               (unsigned long long) events->clocks(),
+               events->clocks() ? double(events->bytes()) / events->clocks()
+                                : 0.0);
+        if (!events->good()) {
+            fprintf(stderr, "Error: writing %s failed\n", event_log_file);
+            failed = true;
+        }
+        delete events;
+    }
+
+    if (trigger) {
+        trigger->finish();
+        trigger->report();
+        delete trigger;
+    }
+
+    if (host) {
+        host->report();
+        delete host;
+    }
+
+    delete ref_model;
+
     if (trace) {
-        trace->close();
+        trace->close();  // Joins the FST writer / VCD compressor thread
         delete trace;
-        std::cout << "VCD trace saved to " << trace_file << "\n";
+        std::cout << TRACE_FORMAT " trace saved to " << trace_file << "\n";
+
+        // Waveform cost: bytes on disk per simulated clock (2 dumps/clock)
+        struct stat st;
+        bool have_size = stat(trace_file, &st) == 0;
+        if (have_size && trace_time > 0) {
+            double traced_clocks = trace_time / 2.0;
+            printf("Trace size: %lld bytes, %.0f clocks (%.2f bytes/clock)\n",
+                   (long long) st.st_size, traced_clocks,
+                   st.st_size / traced_clocks);
+        }
+#if TRACE_COMPRESSION
+        trace_sink->report(have_size ? (long long) st.st_size : -1);
+        failed |= !trace_sink->good();
+        delete trace_sink;
+#endif
         std::cout << "View with: surfer " << trace_file << "\n";
     }
 
@@ -1634,5 +4250,59 @@ int main(int argc, char **argv)
     SDL_DestroyWindow(window);
     SDL_Quit();
 
-    return EXIT_SUCCESS;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Video modes linked into this binary
+struct ModeEntry {
+    const char *id;
+    const char *name;
+    int (*run)(int, char **);
+};
+
+#define MODE_ENTRY(mode, model) \
+    {mode::ID, mode::MODE_NAME, run_simulation<mode, model>}
+static const ModeEntry modes[] = {
+#if SIM_ALL_MODES
+    MODE_ENTRY(Mode_VGA_640x480_72, Vvga_nyancat_VGA_640x480_72),
+    MODE_ENTRY(Mode_VGA_640x480_60, Vvga_nyancat_VGA_640x480_60),
+    MODE_ENTRY(Mode_VGA_800x600_60, Vvga_nyancat_VGA_800x600_60),
+    MODE_ENTRY(Mode_SVGA_800x600_72, Vvga_nyancat_SVGA_800x600_72),
+    MODE_ENTRY(Mode_XGA_1024x768_60, Vvga_nyancat_XGA_1024x768_60),
+#else
+    MODE_ENTRY(DefaultMode, Vvga_nyancat),
+#endif
+};
+#undef MODE_ENTRY
+
+static void print_modes(FILE *fp)
+{
+    fprintf(fp, "Video modes in this build (--mode):\n");
+    for (const ModeEntry &m : modes)
+        fprintf(fp, "  %-16s %s%s\n", m.id, m.name,
+                strcmp(m.id, DefaultMode::ID) == 0 ? " (default)" : "");
+}
+
+int main(int argc, char **argv)
+{
+    const char *mode_id = DefaultMode::ID;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            mode_id = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            std::cout << "\n";
+            print_modes(stdout);
+            return EXIT_SUCCESS;
+        }
+    }
+
+    for (const ModeEntry &m : modes) {
+        if (strcmp(m.id, mode_id) == 0)
+            return m.run(argc, argv);
+    }
+    fprintf(stderr, "Error: video mode '%s' is not in this build%s\n", mode_id,
+            SIM_ALL_MODES ? "" : " (build/sim-all has all modes)");
+    print_modes(stderr);
+    return EXIT_FAILURE;
 }
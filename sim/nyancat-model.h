@@ -0,0 +1,265 @@
+// VGA Nyancat is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+//
+// Cycle-accurate C++ reference model of vga_sync_gen + nyancat
+//
+// Reproduces the RTL datapath register-for-register so it can run in lockstep
+// with the Verilated design, or stand in for it when only pixels are needed.
+//
+// Modeled state (names follow the RTL):
+//   vga_sync_gen: hc, vc, x_px, y_px (x_px/y_px lag hc/vc by one clock)
+//   nyancat:      frame_counter, frame_index, coords_valid, char_idx_q,
+//                 in_display_q, color_q, in_display_q2 (2-stage ROM →
+//                 palette pipeline)
+//
+// Port-compatible with Vvga_nyancat: drive clk/reset_n, call eval(), read
+// hsync/vsync/activevideo/rrggbb. A rising clk edge seen by eval() performs
+// one posedge update, so simulate_frame() can be instantiated on either type.
+//
+// Register widths are truncated exactly as the RTL does (e.g. x_px wraps
+// modulo 2^X_COORD_WIDTH during blanking), so the model stays bit-exact even
+// for addresses that are later gated off by in_display. Source coordinates
+// are computed here as rel / SCALE; the RTL tracks them with incremental
+// counters, so lockstep also checks that those stay equivalent.
+//
+// With NYANCAT_FRAME_DELTA (make FRAME_ROM=delta) the RTL shows frame_index
+// as latched at the start of vertical blanking (its frame buffer is patched
+// there), so the model addresses frame_mem with that show_frame instead.
+// With NYANCAT_FRAME_VSYNC (make FRAME_ADVANCE=vsync) a step that comes due
+// is held in step_pending and applied to frame_index at that same point.
+//
+// Templated on the video mode traits (videomode.h), like the harness.
+
+#ifndef NYANCAT_MODEL_H
+#define NYANCAT_MODEL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "videomode.h"
+
+#ifndef NYANCAT_FRAME_DELTA
+#define NYANCAT_FRAME_DELTA 0
+#endif
+#ifndef NYANCAT_FRAME_VSYNC
+#define NYANCAT_FRAME_VSYNC 0
+#endif
+
+template <typename Mode>
+class NyancatModel
+{
+public:
+    USE_VIDEO_MODE(Mode);
+
+    // Geometry and animation constants (must match nyancat.v localparams)
+    static constexpr int FRAME_W = 64, FRAME_H = 64;
+    static constexpr int SCALE = V_RES / FRAME_H;
+    static constexpr int SCALED_W = FRAME_W * SCALE;
+    static constexpr int SCALED_H = FRAME_H * SCALE;
+    static constexpr int OFFSET_X = (H_RES - SCALED_W) / 2, OFFSET_Y = 0;
+    static constexpr int NUM_FRAMES = 12;
+    static constexpr int FRAME_SIZE = FRAME_W * FRAME_H;
+    static constexpr int FRAME_ADDR_W = clog2(NUM_FRAMES * FRAME_SIZE);
+    static constexpr int FRAME_PERIOD = 2835000;
+
+    // Top-level ports (same names and widths as Vvga_nyancat)
+    uint8_t clk = 0, reset_n = 0;
+    uint8_t hsync = 1, vsync = 1, activevideo = 0, rrggbb = 0;
+
+    // Architectural state, public for divergence reports
+    struct State {
+        uint32_t hc, vc;              // vga_sync_gen counters
+        uint32_t x_px, y_px;          // Registered pixel coordinates
+        uint32_t frame_counter;       // Clocks within current animation frame
+        uint32_t frame_index;         // Animation frame [0, NUM_FRAMES-1]
+        uint32_t show_frame;          // Frame displayed (delta builds only)
+        bool step_pending;            // Step waiting for vblank (vsync builds)
+        uint8_t char_idx_q;           // Stage 1: character index
+        uint8_t color_q;              // Stage 2: palette color
+        bool coords_valid;            // activevideo, one clock late
+        bool in_display_q, in_display_q2;
+    };
+
+    NyancatModel()
+        : frame_mem(NUM_FRAMES * FRAME_SIZE, 0), color_mem(16, 0)
+    {
+        memset(&state, 0, sizeof(state));
+        update_outputs();
+    }
+
+    // Load the same ROM images nyancat.v reads with $readmemh
+    bool load(const char *frames_file = "nyancat-frames.hex",
+              const char *colors_file = "nyancat-colors.hex")
+    {
+        int frames = load_hex(frames_file, frame_mem.data(), frame_mem.size());
+        int colors = load_hex(colors_file, color_mem.data(), color_mem.size());
+        if (frames <= 0 || colors <= 0) {
+            fprintf(stderr, "[REF MODEL] Failed to load %s / %s\n",
+                    frames_file, colors_file);
+            return false;
+        }
+        return true;
+    }
+
+    // Evaluate model: rising clk edge advances one clock
+    void eval()
+    {
+        if (clk && !prev_clk)
+            posedge(!reset_n);
+        prev_clk = clk;
+        update_outputs();
+    }
+
+    void final() {}
+
+    const State &get_state() const { return state; }
+
+    // Print full model state (used for lockstep divergence reports)
+    void dump_state(FILE *fp) const
+    {
+        fprintf(fp,
+                "  hc=%u vc=%u x_px=%u y_px=%u\n"
+                "  frame_counter=%u frame_index=%u\n"
+                "  char_idx_q=%u in_display_q=%d color_q=0x%02x "
+                "in_display_q2=%d\n"
+                "  outputs: hsync=%d vsync=%d activevideo=%d rrggbb=0x%02x\n",
+                state.hc, state.vc, state.x_px, state.y_px,
+                state.frame_counter, state.frame_index, state.char_idx_q,
+                state.in_display_q, state.color_q, state.in_display_q2, hsync,
+                vsync, activevideo, rrggbb);
+#if NYANCAT_FRAME_DELTA
+        fprintf(fp, "  show_frame=%u\n", state.show_frame);
+#endif
+#if NYANCAT_FRAME_VSYNC
+        fprintf(fp, "  step_pending=%d\n", state.step_pending);
+#endif
+    }
+
+    // Minimal $readmemh: whitespace-separated hex words, '//' comments
+    // (also used by the Wishbone memory model)
+    static int load_hex(const char *filename, uint8_t *mem, int depth)
+    {
+        FILE *fp = fopen(filename, "r");
+        if (!fp)
+            return -1;
+
+        int count = 0;
+        char line[256];
+        while (count < depth && fgets(line, sizeof(line), fp)) {
+            char *comment = strstr(line, "//");
+            if (comment)
+                *comment = '\0';
+            for (char *tok = strtok(line, " \t\r\n"); tok && count < depth;
+                 tok = strtok(nullptr, " \t\r\n"))
+                mem[count++] = strtoul(tok, nullptr, 16);
+        }
+        fclose(fp);
+        return count;
+    }
+
+private:
+    static constexpr uint32_t X_MASK = (1u << X_COORD_WIDTH) - 1;
+    static constexpr uint32_t Y_MASK = (1u << Y_COORD_WIDTH) - 1;
+    static constexpr uint32_t ADDR_MASK = (1u << FRAME_ADDR_W) - 1;
+
+    std::vector<uint8_t> frame_mem;  // 4-bit character indices
+    std::vector<uint8_t> color_mem;  // 6-bit RRGGBB palette
+    State state;
+    uint8_t prev_clk = 0;
+
+    // One rising edge: all right-hand sides use pre-edge state, mirroring
+    // the nonblocking assignments in vga-sync-gen.v and nyancat.v
+    void posedge(bool reset)
+    {
+        State &s = state;
+
+        if (reset) {
+            s.hc = s.vc = 0;
+            s.x_px = s.y_px = 0;
+            s.frame_counter = 0;
+            s.frame_index = 0;
+            s.step_pending = false;
+#if NYANCAT_FRAME_DELTA
+            // The RTL buffer catches up from whatever frame it held; as
+            // from power-up, the model assumes frame 0
+            s.show_frame = 0;
+#endif
+            s.coords_valid = false;
+            s.in_display_q = s.in_display_q2 = false;
+            return;
+        }
+
+        // nyancat: coordinate transform from registered x_px/y_px
+        bool in_display_x = s.x_px >= (uint32_t) OFFSET_X &&
+                            s.x_px < (uint32_t) (OFFSET_X + SCALED_W);
+        bool in_display_y = s.y_px >= (uint32_t) OFFSET_Y &&
+                            s.y_px < (uint32_t) (OFFSET_Y + SCALED_H);
+        uint32_t rel_x = (s.x_px - OFFSET_X) & X_MASK;
+        uint32_t rel_y = (s.y_px - OFFSET_Y) & Y_MASK;
+        uint32_t src_x = (rel_x / SCALE) & 0x3f;
+        uint32_t src_y = (rel_y / SCALE) & 0x3f;
+#if NYANCAT_FRAME_DELTA
+        uint32_t frame = s.show_frame;
+#else
+        uint32_t frame = s.frame_index;
+#endif
+        uint32_t frame_addr =
+            (frame * FRAME_SIZE + src_y * FRAME_W + src_x) & ADDR_MASK;
+
+        // nyancat: 2-stage pipeline (out-of-range ROM reads return 0)
+        s.color_q = color_mem[s.char_idx_q & 0xf];
+        s.char_idx_q =
+            frame_addr < frame_mem.size() ? frame_mem[frame_addr] : 0;
+        s.in_display_q2 = s.in_display_q;
+        s.in_display_q = in_display_x && in_display_y && s.coords_valid;
+        bool active = s.hc >= H_BLANKING && s.vc >= V_BLANKING;
+        bool vblank_start =
+            s.coords_valid && !active && s.y_px == (uint32_t) V_RES - 1;
+#if NYANCAT_FRAME_DELTA
+        // nyancat: vblank_start latches the frame the buffer is patched to
+        if (vblank_start)
+            s.show_frame = s.frame_index;
+#endif
+        s.coords_valid = active;
+
+        // nyancat: frame sequencing (vsync builds hold the step for
+        // vblank_start)
+        bool wrap = s.frame_counter >= FRAME_PERIOD - 1;
+        bool step = wrap;
+#if NYANCAT_FRAME_VSYNC
+        step = vblank_start && (s.step_pending || wrap);
+        s.step_pending = !vblank_start && (s.step_pending || wrap);
+#else
+        (void) vblank_start;
+#endif
+        s.frame_counter = wrap ? 0 : s.frame_counter + 1;
+        if (step)
+            s.frame_index =
+                (s.frame_index == NUM_FRAMES - 1) ? 0 : s.frame_index + 1;
+
+        // vga_sync_gen: coordinates registered from pre-edge counters
+        s.x_px = (s.hc - H_BLANKING) & X_MASK;
+        s.y_px = (s.vc - V_BLANKING) & Y_MASK;
+        if (s.hc < H_TOTAL - 1) {
+            s.hc++;
+        } else {
+            s.hc = 0;
+            s.vc = (s.vc < V_TOTAL - 1) ? s.vc + 1 : 0;
+        }
+    }
+
+    // Combinational outputs of vga_sync_gen and nyancat
+    void update_outputs()
+    {
+        const State &s = state;
+        hsync = !(s.hc >= H_FP && s.hc < H_FP + H_SYNC);
+        vsync = !(s.vc >= V_FP && s.vc < V_FP + V_SYNC);
+        activevideo = s.hc >= H_BLANKING && s.vc >= V_BLANKING;
+        rrggbb = (activevideo && s.in_display_q2) ? s.color_q : 0;
+    }
+};
+
+#endif  // NYANCAT_MODEL_H
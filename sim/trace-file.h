@@ -0,0 +1,295 @@
+// VGA Nyancat is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+//
+// VCD output sink with optional background compression
+//
+// Plugs into VerilatedVcdC through its VerilatedVcdFile hook, so the VCD
+// writer itself is untouched. The codec is chosen from the file name:
+//   *.vcd      written directly on the eval thread (baseline)
+//   *.vcd.gz   zlib, compressed on a background thread
+//   *.vcd.zst  zstd (when built with HAVE_ZSTD), background thread
+//
+// Compressed output: write() copies VCD text into BLOCK_SIZE blocks and
+// hands full blocks to the compressor thread through a queue bounded at
+// QUEUE_BLOCKS. The eval thread only blocks when the compressor falls that
+// far behind; that wait is reported as stall time, next to the time the
+// raw writer spends in fwrite(), so both modes can be compared directly.
+//
+// Write errors: VerilatedVcdC ignores write() results and the compressor
+// thread has no caller to return them to, so failed fwrite()/gzwrite()/
+// ZSTD calls are counted and close() reports them; good() tells the caller.
+
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <sys/types.h>
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include "verilated_vcd_c.h"
+
+class TraceFile : public VerilatedVcdFile
+{
+public:
+    enum Codec { RAW, GZIP, ZSTD };
+
+    static constexpr size_t BLOCK_SIZE = 1 << 20;  // 1 MiB of VCD text
+    static constexpr size_t QUEUE_BLOCKS = 8;      // Bounded queue depth
+
+    explicit TraceFile(Codec codec) : codec(codec) {}
+    ~TraceFile() override { close(); }
+
+    // Codec implied by the file name suffix
+    static Codec codec_for(const char *filename)
+    {
+        if (ends_with(filename, ".gz"))
+            return GZIP;
+        if (ends_with(filename, ".zst"))
+            return ZSTD;
+        return RAW;
+    }
+
+    static bool is_available(Codec codec)
+    {
+#if defined(HAVE_ZSTD)
+        return true;
+#else
+        return codec != ZSTD;
+#endif
+    }
+
+    static const char *codec_name(Codec codec)
+    {
+        return codec == GZIP ? "zlib" : codec == ZSTD ? "zstd" : "none";
+    }
+
+    bool open(const std::string &name) override
+    {
+        filename = name;
+        if (codec == GZIP) {
+            gz = gzopen(name.c_str(), "wb6");
+            if (!gz)
+                return false;
+        } else {
+            fp = fopen(name.c_str(), "wb");
+            if (!fp)
+                return false;
+        }
+#if defined(HAVE_ZSTD)
+        if (codec == ZSTD) {
+            zcctx = ZSTD_createCCtx();
+            ZSTD_CCtx_setParameter(zcctx, ZSTD_c_compressionLevel, 3);
+            zout.resize(ZSTD_CStreamOutSize());
+        }
+#endif
+        if (codec != RAW) {
+            block.reserve(BLOCK_SIZE);
+            worker = std::thread(&TraceFile::compress_loop, this);
+        }
+        return true;
+    }
+
+    // Called by VerilatedVcdC on the eval thread
+    ssize_t write(const char *bufp, ssize_t len) override
+    {
+        auto start = std::chrono::steady_clock::now();
+        raw_bytes += len;
+        if (codec == RAW) {
+            size_t n = fwrite(bufp, 1, len, fp);
+            write_ns += elapsed_ns(start);
+            if (n != (size_t) len) {
+                write_errors++;
+                return -1;
+            }
+            return len;
+        }
+
+        ssize_t left = len;
+        while (left > 0) {
+            size_t n = std::min<size_t>(left, BLOCK_SIZE - block.size());
+            block.insert(block.end(), bufp, bufp + n);
+            bufp += n;
+            left -= n;
+            if (block.size() == BLOCK_SIZE)
+                submit();
+        }
+        write_ns += elapsed_ns(start);
+        return len;
+    }
+
+    void close() override
+    {
+        if (!fp && !gz)
+            return;
+        if (worker.joinable()) {
+            if (!block.empty())
+                submit();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = true;
+            }
+            ready.notify_one();
+            worker.join();
+        }
+        if (gz) {
+            if (gzclose(gz) != Z_OK)
+                write_errors++;
+            gz = nullptr;
+        }
+#if defined(HAVE_ZSTD)
+        if (zcctx) {
+            finish_zstd();
+            ZSTD_freeCCtx(zcctx);
+            zcctx = nullptr;
+        }
+#endif
+        if (fp) {
+            if (fclose(fp) != 0)
+                write_errors++;
+            fp = nullptr;
+        }
+        if (write_errors)
+            fprintf(stderr, "Error: writing %s failed (%llu failed writes)\n",
+                    filename.c_str(), (unsigned long long) write_errors);
+    }
+
+    bool good() const { return write_errors == 0; }
+
+    // Disk bytes are taken from the closed file by the caller (stat)
+    void report(long long disk_bytes) const
+    {
+        printf("Trace output: %s, %llu VCD bytes -> %lld bytes on disk",
+               codec_name(codec), (unsigned long long) raw_bytes, disk_bytes);
+        if (disk_bytes > 0 && codec != RAW)
+            printf(" (%.1fx)", double(raw_bytes) / disk_bytes);
+        printf("\n");
+        if (codec == RAW)
+            printf("Eval-thread time in trace writes: %.1f ms (fwrite)\n",
+                   write_ns / 1e6);
+        else
+            printf("Eval-thread time in trace writes: %.1f ms, stalled %.1f "
+                   "ms on a full queue (%llu blocks, compressor busy %.1f "
+                   "ms)\n",
+                   write_ns / 1e6, stall_ns / 1e6,
+                   (unsigned long long) blocks, compress_ns / 1e6);
+    }
+
+private:
+    Codec codec;
+    std::string filename;
+    FILE *fp = nullptr;
+    gzFile gz = nullptr;
+#if defined(HAVE_ZSTD)
+    ZSTD_CCtx *zcctx = nullptr;
+    std::vector<char> zout;
+#endif
+
+    // Eval thread side
+    std::vector<char> block;
+    uint64_t raw_bytes = 0, write_ns = 0, stall_ns = 0, blocks = 0;
+
+    // Shared queue
+    std::mutex mutex;
+    std::condition_variable ready, space;
+    std::deque<std::vector<char>> queue;
+    bool finished = false;
+    std::thread worker;
+    uint64_t compress_ns = 0;  // Written by worker, read after join
+
+    // Raw mode: eval thread; compressed: worker, read after join
+    uint64_t write_errors = 0;
+
+    static bool ends_with(const char *s, const char *suffix)
+    {
+        size_t n = strlen(s), m = strlen(suffix);
+        return n >= m && strcmp(s + n - m, suffix) == 0;
+    }
+
+    static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+    // Hand the current block to the compressor (blocks if queue is full)
+    void submit()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queue.size() >= QUEUE_BLOCKS) {
+            auto start = std::chrono::steady_clock::now();
+            space.wait(lock, [this] { return queue.size() < QUEUE_BLOCKS; });
+            stall_ns += elapsed_ns(start);
+        }
+        queue.emplace_back(std::move(block));
+        blocks++;
+        lock.unlock();
+        ready.notify_one();
+        block = std::vector<char>();
+        block.reserve(BLOCK_SIZE);
+    }
+
+    void compress_loop()
+    {
+        for (;;) {
+            std::vector<char> data;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return finished || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                data = std::move(queue.front());
+                queue.pop_front();
+            }
+            space.notify_one();
+
+            auto start = std::chrono::steady_clock::now();
+            if (codec == GZIP &&
+                gzwrite(gz, data.data(), data.size()) != (int) data.size())
+                write_errors++;
+#if defined(HAVE_ZSTD)
+            if (codec == ZSTD)
+                compress_zstd(data.data(), data.size(), ZSTD_e_continue);
+#endif
+            compress_ns += elapsed_ns(start);
+        }
+    }
+
+#if defined(HAVE_ZSTD)
+    void compress_zstd(const char *data, size_t size, ZSTD_EndDirective mode)
+    {
+        ZSTD_inBuffer in = {data, size, 0};
+        for (;;) {
+            ZSTD_outBuffer out = {zout.data(), zout.size(), 0};
+            size_t remaining = ZSTD_compressStream2(zcctx, &out, &in, mode);
+            if (fwrite(zout.data(), 1, out.pos, fp) != out.pos)
+                write_errors++;
+            if (ZSTD_isError(remaining)) {
+                write_errors++;
+                return;
+            }
+            bool done = mode == ZSTD_e_end ? remaining == 0
+                                           : in.pos == in.size;
+            if (done)
+                return;
+        }
+    }
+
+    void finish_zstd() { compress_zstd(nullptr, 0, ZSTD_e_end); }
+#endif
+};
+
+#endif  // TRACE_FILE_H
@@ -0,0 +1,139 @@
+// VGA Nyancat is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+//
+// Video mode configuration for the C++ simulation harness
+//
+// Mirrors rtl/videomode.vh so host-side code (harness, validators, reference
+// model) derives the same timing the RTL was elaborated with. All modes are
+// available as traits structs; VIDEO_MODE_* on the compiler command line
+// (see Makefile) selects DefaultMode, the mode of a single-mode build.
+
+#ifndef VIDEOMODE_H
+#define VIDEOMODE_H
+
+#if !defined(VIDEO_MODE_VGA_640x480_72) &&  \
+    !defined(VIDEO_MODE_VGA_640x480_60) &&  \
+    !defined(VIDEO_MODE_VGA_800x600_60) &&  \
+    !defined(VIDEO_MODE_SVGA_800x600_72) && \
+    !defined(VIDEO_MODE_XGA_1024x768_60)
+// Default to VGA 640×480 @ 72Hz if no mode specified
+#define VIDEO_MODE_VGA_640x480_72
+#endif
+
+// Programmable timing build (make TIMING_REGS=1 passes the same define to
+// Verilator and to this file): the RTL sizes its counters and coordinates
+// for the largest supported mode and takes the timing from registers
+#ifndef VGA_TIMING_REGS
+#define VGA_TIMING_REGS 0
+#endif
+
+// Register map of the cfg_* bus (TIMING_REG_* in videomode.vh)
+enum TimingReg {
+    TIMING_REG_H_ACTIVE = 0,
+    TIMING_REG_H_FP = 1,
+    TIMING_REG_H_SYNC = 2,
+    TIMING_REG_H_BP = 3,
+    TIMING_REG_V_ACTIVE = 4,
+    TIMING_REG_V_FP = 5,
+    TIMING_REG_V_SYNC = 6,
+    TIMING_REG_V_BP = 7,
+    TIMING_REG_SCALE = 8,
+    TIMING_REG_OFFSET_X = 9,
+    TIMING_REG_APPLY = 15,
+};
+
+// Largest supported mode (*_MAX in videomode.vh)
+static constexpr int H_RES_MAX = 1024, V_RES_MAX = 768;
+static constexpr int H_TOTAL_MAX = 1344, V_TOTAL_MAX = 806;
+
+// Equivalent of Verilog $clog2() for deriving RTL register widths
+constexpr int clog2(int value)
+{
+    int bits = 0;
+    while ((1 << bits) < value)
+        bits++;
+    return bits;
+}
+
+// Timing of one video mode plus everything derived from it. Host-side code
+// is templated on a mode traits struct (below) so every mode keeps its own
+// constexpr-specialized loops; USE_VIDEO_MODE() brings the names into scope.
+template <int HRes, int HFp, int HSync, int HBp,
+          int VRes, int VFp, int VSync, int VBp>
+struct VideoTiming {
+    static constexpr int H_RES = HRes, V_RES = VRes;
+    static constexpr int H_FP = HFp, H_SYNC = HSync, H_BP = HBp;
+    static constexpr int V_FP = VFp, V_SYNC = VSync, V_BP = VBp;
+
+    // Computed timing values
+    static constexpr int H_BLANKING = H_FP + H_SYNC + H_BP;
+    static constexpr int V_BLANKING = V_FP + V_SYNC + V_BP;
+    static constexpr int H_TOTAL = H_RES + H_BLANKING;
+    static constexpr int V_TOTAL = V_RES + V_BLANKING;
+    static constexpr int CLOCKS_PER_FRAME = H_TOTAL * V_TOTAL;
+
+    // Register widths as elaborated by videomode.vh
+    static constexpr int X_COORD_WIDTH =
+        clog2(VGA_TIMING_REGS ? H_RES_MAX : H_RES);
+    static constexpr int Y_COORD_WIDTH =
+        clog2(VGA_TIMING_REGS ? V_RES_MAX : V_RES);
+};
+
+// Video mode timing parameters (must match videomode.vh). ID is the
+// VIDEO_MODE_* suffix, also accepted by the simulator's --mode option.
+struct Mode_VGA_640x480_72 : VideoTiming<640, 24, 40, 128, 480, 9, 3, 28> {
+    static constexpr const char *ID = "VGA_640x480_72";
+    static constexpr const char *MODE_NAME = "VGA 640x480 @ 72Hz";
+};
+struct Mode_VGA_640x480_60 : VideoTiming<640, 16, 96, 48, 480, 10, 2, 33> {
+    static constexpr const char *ID = "VGA_640x480_60";
+    static constexpr const char *MODE_NAME = "VGA 640x480 @ 60Hz";
+};
+struct Mode_VGA_800x600_60 : VideoTiming<800, 40, 128, 88, 600, 1, 4, 23> {
+    static constexpr const char *ID = "VGA_800x600_60";
+    static constexpr const char *MODE_NAME = "SVGA 800x600 @ 60Hz";
+};
+struct Mode_SVGA_800x600_72 : VideoTiming<800, 56, 120, 64, 600, 37, 6, 23> {
+    static constexpr const char *ID = "SVGA_800x600_72";
+    static constexpr const char *MODE_NAME = "SVGA 800x600 @ 72Hz";
+};
+struct Mode_XGA_1024x768_60
+    : VideoTiming<1024, 24, 136, 160, 768, 3, 6, 29> {
+    static constexpr const char *ID = "XGA_1024x768_60";
+    static constexpr const char *MODE_NAME = "XGA 1024x768 @ 60Hz";
+};
+
+// Mode the RTL of a single-mode build was elaborated with
+#if defined(VIDEO_MODE_VGA_640x480_72)
+typedef Mode_VGA_640x480_72 DefaultMode;
+#elif defined(VIDEO_MODE_VGA_640x480_60)
+typedef Mode_VGA_640x480_60 DefaultMode;
+#elif defined(VIDEO_MODE_VGA_800x600_60)
+typedef Mode_VGA_800x600_60 DefaultMode;
+#elif defined(VIDEO_MODE_SVGA_800x600_72)
+typedef Mode_SVGA_800x600_72 DefaultMode;
+#elif defined(VIDEO_MODE_XGA_1024x768_60)
+typedef Mode_XGA_1024x768_60 DefaultMode;
+#endif
+
+// Import the timing constants of Mode into a class or function scope
+#define USE_VIDEO_MODE(Mode)                                             \
+    [[maybe_unused]] static constexpr int H_RES = Mode::H_RES,           \
+                                          V_RES = Mode::V_RES,           \
+                                          H_FP = Mode::H_FP,             \
+                                          H_SYNC = Mode::H_SYNC,         \
+                                          H_BP = Mode::H_BP,             \
+                                          V_FP = Mode::V_FP,             \
+                                          V_SYNC = Mode::V_SYNC,         \
+                                          V_BP = Mode::V_BP,             \
+                                          H_BLANKING = Mode::H_BLANKING, \
+                                          V_BLANKING = Mode::V_BLANKING, \
+                                          H_TOTAL = Mode::H_TOTAL,       \
+                                          V_TOTAL = Mode::V_TOTAL;       \
+    [[maybe_unused]] static constexpr int                                \
+        CLOCKS_PER_FRAME = Mode::CLOCKS_PER_FRAME,                       \
+        X_COORD_WIDTH = Mode::X_COORD_WIDTH,                             \
+        Y_COORD_WIDTH = Mode::Y_COORD_WIDTH;                             \
+    [[maybe_unused]] static constexpr const char *MODE_NAME = Mode::MODE_NAME
+
+#endif  // VIDEOMODE_H
@@ -0,0 +1,263 @@
+// VGA Nyancat is freely redistributable under the MIT License. See the file
+// "LICENSE" for information on usage and redistribution of this file.
+//
+// Wishbone slave model of the external nyancat frame memory
+//
+// Backs the wb_* read port of a NYANCAT_FRAME_MEM_WB build with the same
+// nyancat-frames.hex image the ROM build loads. tick() runs once per clock
+// after the rising edge: it samples the master's request and drives
+// wb_stall_i / wb_ack_i / wb_dat_i for the rest of that clock, so the next
+// edge sees them. A zero-wait-state acknowledge therefore lands in the
+// request's own clock, the latency of the on-chip ROM. The master issues
+// reads MEM_LATENCY clocks before they are due (prefetch), so stalls plus
+// wait states of up to MEM_LATENCY clocks per read are hidden.
+//
+// Latency injection (--wb-wait, --wb-stall, --wb-seed):
+//   - wait_states W: an accepted request is acknowledged W clocks later,
+//     in order, at most one acknowledge per clock
+//   - stall_rate p: each clock the slave stalls with probability p, as if
+//     another master (a CPU) owned the memory; it also stalls while
+//     MAX_OUTSTANDING requests are queued
+//   - wb_cyc_o low ends the bus cycle and drops queued requests
+//
+// Protocol check: a request presented while the slave stalls must be on the
+// bus again, unchanged (wb_stb_o high, same wb_adr_o), on the next clock
+// unless the master ends the cycle (Wishbone B4 pipelined). Violations are
+// counted and fail the run (hold_violations()).
+//
+// Statistics per displayed frame (rows delimited by vsync falling edges):
+// accepted requests, stall cycles (wb_stb_o && wb_stall_i), peak and mean
+// number of outstanding requests over bus-cycle clocks, and missed pixels,
+// read from nyancat.v's frame_misses counter (a character not back by its
+// due clock).
+//
+// Templated on the video mode traits (videomode.h), like the harness.
+
+#ifndef WISHBONE_MEM_H
+#define WISHBONE_MEM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "nyancat-model.h"
+
+// Prefetch depth of the RTL build (make MEM_LATENCY=N passes it to both)
+#ifndef MEM_LATENCY
+#define MEM_LATENCY 0
+#endif
+
+template <typename Mode>
+class WishboneMemory
+{
+public:
+    static constexpr int MAX_OUTSTANDING = 32;  // Slave request queue depth
+
+    struct Config {
+        int wait_states = 0;
+        double stall_rate = 0.0;  // Probability of a stall per clock
+        uint32_t seed = 1;
+    };
+
+    explicit WishboneMemory(const Config &config)
+        : cfg(config),
+          mem(NyancatModel<Mode>::NUM_FRAMES * NyancatModel<Mode>::FRAME_SIZE,
+              0),
+          rng(config.seed ? config.seed : 1)
+    {
+    }
+
+    bool load(const char *frames_file = "nyancat-frames.hex")
+    {
+        if (NyancatModel<Mode>::load_hex(frames_file, mem.data(),
+                                         mem.size()) <= 0) {
+            fprintf(stderr, "[WB MEM] Failed to load %s\n", frames_file);
+            return false;
+        }
+        return true;
+    }
+
+    // One clock, after the rising edge: answer the master's request
+    template <typename Top>
+    void tick(Top *top)
+    {
+        // Registered miss counter: misses up to the previous clock
+        uint32_t misses =
+            top->rootp->vga_nyancat__DOT__nyan__DOT__frame_misses;
+        current.misses = misses - row_misses;
+
+        // Frame boundary: vsync falling edge closes the current row
+        if (!top->vsync && prev_vsync) {
+            if (frame_started)
+                rows.push_back(current);
+            current = {};
+            row_misses = misses;
+            frame_started = true;
+        }
+        prev_vsync = top->vsync;
+
+        if (!top->wb_cyc_o)
+            queue.clear();  // End of bus cycle aborts queued requests
+        else if (held && (!top->wb_stb_o || top->wb_adr_o != held_adr)) {
+            if (violations++ == 0)
+                fprintf(stderr,
+                        "[WB MEM] Clock %llu: stalled request 0x%x left the "
+                        "bus before acceptance (stb=%d adr=0x%x)\n",
+                        (unsigned long long) clock, (unsigned) held_adr,
+                        (int) top->wb_stb_o, (unsigned) top->wb_adr_o);
+        }
+
+        bool stall = (int) queue.size() >= MAX_OUTSTANDING ||
+                     (cfg.stall_rate > 0 && random_unit() < cfg.stall_rate);
+        bool accept = top->wb_stb_o && !stall;
+        held = top->wb_stb_o && stall;
+        held_adr = top->wb_adr_o;
+        if (accept)
+            queue.push_back({top->wb_adr_o, clock + cfg.wait_states});
+
+        bool ack = !queue.empty() && queue.front().ready <= clock;
+        top->wb_stall_i = stall;
+        top->wb_ack_i = ack;
+        if (ack) {
+            uint32_t addr = queue.front().addr;
+            top->wb_dat_i = addr < mem.size() ? mem[addr] : 0;
+            queue.pop_front();
+        }
+
+        current.requests += accept;
+        current.stalls += top->wb_stb_o && stall;
+        if (top->wb_cyc_o) {
+            current.cyc_clocks++;
+            current.outstanding_sum += queue.size();
+            current.max_outstanding =
+                std::max<uint64_t>(current.max_outstanding, queue.size());
+        }
+        clock++;
+    }
+
+    // The reference model has no bus; nothing to answer
+    void tick(NyancatModel<Mode> *) {}
+
+    // Keep the trailing (possibly partial) frame as a row
+    void finish()
+    {
+        if (current.requests > 0 || current.cyc_clocks > 0)
+            rows.push_back(current);
+        current = {};
+    }
+
+    uint64_t hold_violations() const { return violations; }
+
+    uint64_t total_misses() const
+    {
+        uint64_t n = current.misses;
+        for (const Row &r : rows)
+            n += r.misses;
+        return n;
+    }
+
+    void report() const
+    {
+        Row total = current;
+        for (const Row &r : rows) {
+            total.requests += r.requests;
+            total.stalls += r.stalls;
+            total.misses += r.misses;
+            total.cyc_clocks += r.cyc_clocks;
+            total.outstanding_sum += r.outstanding_sum;
+            total.max_outstanding =
+                std::max(total.max_outstanding, r.max_outstanding);
+        }
+
+        printf("\n========================================\n");
+        printf("Wishbone Frame Memory\n");
+        printf("========================================\n\n");
+        printf("Slave: %d wait state%s, stall rate %.3f (seed %u), "
+               "queue depth %d\n",
+               cfg.wait_states, cfg.wait_states == 1 ? "" : "s",
+               cfg.stall_rate, cfg.seed, MAX_OUTSTANDING);
+        printf("Master: prefetch MEM_LATENCY=%d (hides up to %d clocks of "
+               "stalls + wait states per read)\n\n",
+               MEM_LATENCY, MEM_LATENCY);
+        printf("Requests:        %llu accepted\n",
+               (unsigned long long) total.requests);
+        printf("Stall cycles:    %llu\n", (unsigned long long) total.stalls);
+        printf("Outstanding:     peak %llu, mean %.2f over %llu bus clocks\n",
+               (unsigned long long) total.max_outstanding, total.mean(),
+               (unsigned long long) total.cyc_clocks);
+        printf("Missed pixels:   %llu (%.2f%% of requests)\n",
+               (unsigned long long) total.misses,
+               total.requests ? 100.0 * total.misses / total.requests : 0.0);
+        printf("Hold violations: %llu (stalled request changed before "
+               "acceptance)\n",
+               (unsigned long long) violations);
+
+        if (!rows.empty()) {
+            printf("\nPer-frame breakdown:\n");
+            printf("  %5s %10s %10s %10s %6s %8s\n", "frame", "requests",
+                   "stalls", "missed", "peak", "mean");
+            size_t shown = std::min<size_t>(rows.size(), 16);
+            for (size_t i = 0; i < shown; ++i) {
+                const Row &r = rows[i];
+                printf("  %5zu %10llu %10llu %10llu %6llu %8.2f\n", i,
+                       (unsigned long long) r.requests,
+                       (unsigned long long) r.stalls,
+                       (unsigned long long) r.misses,
+                       (unsigned long long) r.max_outstanding, r.mean());
+            }
+            if (rows.size() > shown)
+                printf("  ... %zu more\n", rows.size() - shown);
+        }
+        printf("\n%s: frame memory %s every pixel deadline\n",
+               total.misses ? "FAIL" : "PASS",
+               total.misses ? "missed" : "met");
+        printf("%s: master %s stalled requests until accepted\n",
+               violations ? "FAIL" : "PASS", violations ? "changed" : "held");
+        printf("========================================\n");
+    }
+
+private:
+    struct Request {
+        uint32_t addr;
+        uint64_t ready;  // Clock of the acknowledge
+    };
+
+    struct Row {
+        uint64_t requests = 0, stalls = 0, misses = 0;
+        uint64_t cyc_clocks = 0, outstanding_sum = 0, max_outstanding = 0;
+
+        double mean() const
+        {
+            return cyc_clocks ? double(outstanding_sum) / cyc_clocks : 0.0;
+        }
+    };
+
+    Config cfg;
+    std::vector<uint8_t> mem;
+    std::deque<Request> queue;
+    uint64_t clock = 0;
+    uint32_t rng;
+
+    // Request presented while stalled on the previous clock
+    bool held = false;
+    uint32_t held_adr = 0;
+    uint64_t violations = 0;
+
+    std::vector<Row> rows;
+    Row current;
+    uint32_t row_misses = 0;  // frame_misses at the start of the current row
+    bool frame_started = false, prev_vsync = true;
+
+    // xorshift32: reproducible stall pattern for a given --wb-seed
+    double random_unit()
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng / 4294967296.0;
+    }
+};
+
+#endif  // WISHBONE_MEM_H